@@ -0,0 +1,35 @@
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+
+//largest relative difference between two values, absolute below 1
+inline double calcRelativeDifference(double value, double reference)
+{
+	return std::abs(value - reference) / std::max(std::abs(reference), 1.0);
+}
+
+//print one comparison and whether it stays within the accepted limit
+inline bool reportAccuracy(const std::string& name, double maxDifference, double limit)
+{
+	bool passed = maxDifference <= limit;
+	std::printf("%-60s %12.3e  (limit %.1e) %s\n", name.c_str(), maxDifference, limit, passed ? "ok" : "FAILED");
+
+	return passed;
+}
+
+//one whole run with the scheme picked by the configurations, the way the simulator runs it
+Parcel runSimulation(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+
+bool checkThermodynamicArrayAccuracy();
+bool checkPseudoadiabatTableAccuracy();
+bool checkThermodynamicPrecisionAccuracy();
+bool checkFloatingPointAccuracy();
+bool checkMultistepAccuracy();
+
+#endif
@@ -0,0 +1,29 @@
+#include "../src/dynamic_scheme.h"
+#include "accuracy.h"
+#include <iostream>
+#include <memory>
+
+Parcel runSimulation(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration)
+{
+    std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(modelConfiguration, parcelConfiguration, environment);
+    Parcel parcel(environment, parcelConfiguration);
+
+    return dynamicScheme->runSimulationOn(parcel);
+}
+
+int main()
+{
+    std::cout << "Running accuracy checks\n";
+
+    bool passed = true;
+
+    passed &= checkThermodynamicArrayAccuracy();
+    passed &= checkPseudoadiabatTableAccuracy();
+    passed &= checkThermodynamicPrecisionAccuracy();
+    passed &= checkFloatingPointAccuracy();
+    passed &= checkMultistepAccuracy();
+
+    std::cout << (passed ? "All accuracy checks passed\n" : "Some accuracy checks failed\n");
+
+    return passed ? 0 : -1;
+}
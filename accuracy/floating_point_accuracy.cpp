@@ -0,0 +1,91 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/parcel_summary.h"
+#include "../src/thermodynamic_calc.h"
+#include "accuracy.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool checkFloatingPointAccuracy()
+{
+    //float instantiations of the thermodynamic functions against double on random states of the troposphere
+    const size_t count = 1000000;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> temperatureRange(190.0, 320.0);
+    std::uniform_real_distribution<double> pressureRange(10000.0, 105000.0);
+
+    double maxMixingRatioDifference = 0.0;
+    double maxAdiabatDifference = 0.0;
+    double maxWetBulbDifference = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        //states rounded to float first, so only the arithmetic differs
+        float temperature = static_cast<float>(temperatureRange(generator));
+        float pressure = static_cast<float>(pressureRange(generator));
+        double mixingRatio = calcMixingRatio<double>(temperature, pressure);
+
+        //states with vapour pressure close to the air pressure do not occur in the atmosphere
+        if (mixingRatio < 0.1)
+        {
+            maxMixingRatioDifference = std::max(maxMixingRatioDifference, std::abs(calcMixingRatio(temperature, pressure) - mixingRatio) / mixingRatio);
+            maxWetBulbDifference = std::max(maxWetBulbDifference, std::abs(calcWBPotentialTemperature(temperature, 0.5f * float(mixingRatio), float(mixingRatio), pressure)
+                - calcWBPotentialTemperature<double>(temperature, 0.5 * float(mixingRatio), float(mixingRatio), pressure)));
+        }
+
+        float gamma = calcGamma(0.001f * (i / 1000 % 20));
+        float lambda = calcLambda(250.0f + (i / 1000 % 70), 90000.0f, gamma);
+        maxAdiabatDifference = std::max(maxAdiabatDifference, calcRelativeDifference(calcTemperatureInAdiabat(pressure, gamma, lambda), calcTemperatureInAdiabat<double>(pressure, gamma, lambda)));
+    }
+
+    bool passed = true;
+
+    passed &= reportAccuracy("float saturation mixing ratio [relative]", maxMixingRatioDifference, 1e-5);
+    passed &= reportAccuracy("float adiabat temperature [relative]", maxAdiabatDifference, 1e-5);
+    passed &= reportAccuracy("float wet-bulb potential temperature [K]", maxWetBulbDifference, 1e-3);
+
+    //CAPE and cloud top of whole 2-hour runs in float against double
+    //float has to stay below the time discretisation error, the change of the double run when its timestep is halved,
+    //or below 1 J/kg and 1 m for runs that have already converged that far
+    std::map<std::string, std::string> parcelConfiguration = {
+        { "output_filename", "output/accuracy.output" }, { "output_mode", "summary" }, { "timestep", "0.1" }, { "period", "2" },
+        { "pseudoadiabatic_scheme", "2" }, { "no_moisture_trsh", "0.00001" }, { "init_velocity", "0.0" },
+        { "init_height", "100" }, { "init_temp", "33" }, { "init_dewpoint", "19" } };
+    std::map<std::string, std::string> modelConfiguration = { { "dynamic_scheme", "2" }, { "adaptive_tolerance", "1e-6" } };
+
+    const std::vector<std::pair<std::string, std::string>> dynamicSchemes = { { "1", "finite difference" }, { "2", "Runge-Kutta" }, { "3", "adaptive Runge-Kutta" } };
+
+    for (const std::string profile : { "12374_20170801_12z.profile", "10393_20200619_12z.profile" })
+    {
+        const Environment environment("input/" + profile);
+
+        for (const auto& [schemeID, schemeName] : dynamicSchemes)
+        {
+            modelConfiguration["dynamic_scheme"] = schemeID;
+
+            parcelConfiguration["timestep"] = "0.1";
+            parcelConfiguration["floating_point"] = "double";
+            ParcelSummary reference = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+            parcelConfiguration["floating_point"] = "float";
+            ParcelSummary single = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+            parcelConfiguration["timestep"] = "0.05";
+            parcelConfiguration["floating_point"] = "double";
+            ParcelSummary halvedStep = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+            std::string name = "float " + schemeName + " " + profile.substr(0, profile.find('_'));
+
+            passed &= reportAccuracy(name + " CAPE [J/kg]", std::abs(single.cape - reference.cape), std::max(std::abs(halvedStep.cape - reference.cape), 1.0));
+            passed &= reportAccuracy(name + " cloud top [m]", std::abs(single.cloudTopHeight - reference.cloudTopHeight), std::max(std::abs(halvedStep.cloudTopHeight - reference.cloudTopHeight), 1.0));
+        }
+    }
+
+    return passed;
+}
@@ -0,0 +1,48 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/parcel_summary.h"
+#include "accuracy.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+bool checkMultistepAccuracy()
+{
+    //whole 2-hour runs of the Adams-Bashforth-Moulton scheme against a Runge-Kutta run at a quarter of its timestep
+    //it has to be at least as accurate as Runge-Kutta at the same number of buoyancy evaluations, that is at a doubled timestep,
+    //or below 1 J/kg, 1 m and 0.01 m/s for runs that have already converged that far
+    std::map<std::string, std::string> parcelConfiguration = {
+        { "output_filename", "output/accuracy.output" }, { "output_mode", "summary" }, { "timestep", "0.05" }, { "period", "2" },
+        { "pseudoadiabatic_scheme", "2" }, { "no_moisture_trsh", "0.00001" }, { "init_velocity", "0.0" },
+        { "init_height", "100" }, { "init_temp", "33" }, { "init_dewpoint", "19" } };
+    std::map<std::string, std::string> modelConfiguration = { { "dynamic_scheme", "2" } };
+
+    bool passed = true;
+
+    for (const std::string profile : { "12374_20170801_12z.profile", "10393_20200619_12z.profile" })
+    {
+        const Environment environment("input/" + profile);
+
+        modelConfiguration["dynamic_scheme"] = "2";
+
+        parcelConfiguration["timestep"] = "0.0125";
+        ParcelSummary reference = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+        parcelConfiguration["timestep"] = "0.1";
+        ParcelSummary rungeKutta = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+        modelConfiguration["dynamic_scheme"] = "4";
+
+        parcelConfiguration["timestep"] = "0.05";
+        ParcelSummary multistep = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+        std::string name = "Adams-Bashforth-Moulton " + profile.substr(0, profile.find('_'));
+
+        passed &= reportAccuracy(name + " CAPE [J/kg]", std::abs(multistep.cape - reference.cape), std::max(std::abs(rungeKutta.cape - reference.cape), 1.0));
+        passed &= reportAccuracy(name + " cloud top [m]", std::abs(multistep.cloudTopHeight - reference.cloudTopHeight), std::max(std::abs(rungeKutta.cloudTopHeight - reference.cloudTopHeight), 1.0));
+        passed &= reportAccuracy(name + " max velocity [m/s]", std::abs(multistep.maxVelocity - reference.maxVelocity), std::max(std::abs(rungeKutta.maxVelocity - reference.maxVelocity), 0.01));
+    }
+
+    return passed;
+}
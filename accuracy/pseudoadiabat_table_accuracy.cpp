@@ -0,0 +1,69 @@
+#include "../src/parcel.h"
+#include "../src/pseudoadiabatic_scheme.h"
+#include "../src/pseudoadiabat_table.h"
+#include "../src/thermodynamic_calc.h"
+#include "accuracy.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+bool checkPseudoadiabatTableAccuracy()
+{
+    //table against the Runge-Kutta pseudoadiabat integrated from 1000 hPa in 0.1 hPa steps, between 1050 and 100 hPa
+    const size_t curveCount = 200;
+    const double stepPressure = 10.0;
+    const double limit = 0.01;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> wetBulbThetaRange(238.15, 318.15);
+
+    const PseudoadiabatTable& table = PseudoadiabatTable::getInstance("");
+    RungeKuttaPseudoadiabat integrator;
+
+    double maxTableDifference = 0.0;
+    double maxFollowDifference = 0.0;
+
+    for (size_t curve = 0; curve < curveCount; curve++)
+    {
+        double wetBulbTheta = wetBulbThetaRange(generator);
+
+        for (double direction : { -1.0, 1.0 })
+        {
+            Parcel::Slice slice;
+            slice.pressure = 100000.0;
+            slice.temperature = wetBulbTheta;
+
+            double previousPressure = slice.pressure;
+            double previousTemperature = slice.temperature;
+            size_t steps = direction < 0 ? 9000 : 500;
+
+            for (size_t i = 1; i <= steps; i++)
+            {
+                slice.mixingRatioSaturated = calcMixingRatio(slice.temperature, slice.pressure);
+                slice.mixingRatio = slice.mixingRatioSaturated;
+                slice.temperature = integrator.calculateCurrentPseudoadiabaticTemperature(slice, direction * stepPressure, 0.0);
+                slice.pressure = 100000.0 + (direction * stepPressure * i);
+
+                //compare every 5 hPa, off the table levels as well
+                if (i % 50 == 17)
+                {
+                    maxTableDifference = std::max(maxTableDifference, std::abs(table.getTemperature(wetBulbTheta, slice.pressure) - slice.temperature));
+
+                    double followedTemperature = table.getTemperatureOnCurveThrough(previousTemperature, previousPressure, slice.pressure, wetBulbTheta + 1.0);
+                    maxFollowDifference = std::max(maxFollowDifference, std::abs(followedTemperature - slice.temperature));
+
+                    previousPressure = slice.pressure;
+                    previousTemperature = slice.temperature;
+                }
+            }
+        }
+    }
+
+    bool passed = true;
+
+    passed &= reportAccuracy("pseudoadiabat table temperature [K]", maxTableDifference, limit);
+    passed &= reportAccuracy("pseudoadiabat table curve following [K]", maxFollowDifference, limit);
+
+    return passed;
+}
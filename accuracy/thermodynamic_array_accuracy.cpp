@@ -0,0 +1,75 @@
+#include "../src/thermodynamic_calc.h"
+#include "accuracy.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+bool checkThermodynamicArrayAccuracy()
+{
+    //array kernels against the scalar functions over the range met in the troposphere and lower stratosphere
+    const size_t count = 100000;
+    const double limit = 1e-13;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> temperatureRange(190.0, 320.0);
+    std::uniform_real_distribution<double> pressureRange(1000.0, 105000.0);
+    std::uniform_real_distribution<double> saturationFraction(0.01, 1.0);
+
+    std::vector<double> temperature(count), pressure(count), mixingRatio(count), satMixingRatio(count), gamma(count), lambda(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        temperature[i] = temperatureRange(generator);
+        pressure[i] = pressureRange(generator);
+        satMixingRatio[i] = calcMixingRatio(temperature[i], pressure[i]);
+        mixingRatio[i] = satMixingRatio[i] * saturationFraction(generator);
+        gamma[i] = calcGamma(mixingRatio[i]);
+        lambda[i] = calcLambda(temperature[i], pressure[i], gamma[i]);
+    }
+
+    std::vector<double> result(count);
+    double maxDifference;
+    bool passed = true;
+
+    calcVapourPressure(temperature.data(), pressure.data(), result.data(), count);
+    maxDifference = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxDifference = std::max(maxDifference, calcRelativeDifference(result[i], calcVapourPressure(temperature[i], pressure[i])));
+    }
+    passed &= reportAccuracy("array calcVapourPressure vs scalar", maxDifference, limit);
+
+    calcMixingRatio(temperature.data(), pressure.data(), result.data(), count);
+    maxDifference = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxDifference = std::max(maxDifference, calcRelativeDifference(result[i], calcMixingRatio(temperature[i], pressure[i])));
+    }
+    passed &= reportAccuracy("array calcMixingRatio vs scalar", maxDifference, limit);
+
+    calcVirtualTemperature(temperature.data(), mixingRatio.data(), result.data(), count);
+    maxDifference = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxDifference = std::max(maxDifference, calcRelativeDifference(result[i], calcVirtualTemperature(temperature[i], mixingRatio[i])));
+    }
+    passed &= reportAccuracy("array calcVirtualTemperature vs scalar", maxDifference, limit);
+
+    calcTemperatureInAdiabat(pressure.data(), gamma.data(), lambda.data(), result.data(), count);
+    maxDifference = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxDifference = std::max(maxDifference, calcRelativeDifference(result[i], calcTemperatureInAdiabat(pressure[i], gamma[i], lambda[i])));
+    }
+    passed &= reportAccuracy("array calcTemperatureInAdiabat vs scalar", maxDifference, limit);
+
+    calcWBPotentialTemperature(temperature.data(), mixingRatio.data(), satMixingRatio.data(), pressure.data(), result.data(), count);
+    maxDifference = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxDifference = std::max(maxDifference, calcRelativeDifference(result[i], calcWBPotentialTemperature(temperature[i], mixingRatio[i], satMixingRatio[i], pressure[i])));
+    }
+    passed &= reportAccuracy("array calcWBPotentialTemperature vs scalar", maxDifference, limit);
+
+    return passed;
+}
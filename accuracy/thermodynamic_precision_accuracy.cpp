@@ -0,0 +1,127 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/parcel_summary.h"
+#include "../src/thermodynamic_calc.h"
+#include "accuracy.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct TrajectoryDeviation
+    {
+        double position = 0.0, velocity = 0.0, temperature = 0.0;
+    };
+
+    TrajectoryDeviation calcMaxDeviation(const Parcel& parcel, const Parcel& reference)
+    {
+        TrajectoryDeviation deviation;
+        size_t steps = std::min(parcel.getStoredSteps(), reference.getStoredSteps());
+
+        for (size_t i = 0; i < steps; i++)
+        {
+            deviation.position = std::max(deviation.position, std::abs(parcel.position[i] - reference.position[i]));
+            deviation.velocity = std::max(deviation.velocity, std::abs(parcel.velocity[i] - reference.velocity[i]));
+            deviation.temperature = std::max(deviation.temperature, std::abs(parcel.temperature[i] - reference.temperature[i]));
+        }
+
+        return deviation;
+    }
+}
+
+bool checkThermodynamicPrecisionAccuracy()
+{
+    //the fast functions against the exact ones on random states of the troposphere
+    const size_t count = 1000000;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> temperatureRange(190.0, 320.0);
+    std::uniform_real_distribution<double> pressureRange(10000.0, 105000.0);
+
+    double maxMixingRatioDifference = 0.0;
+    double maxAdiabatDifference = 0.0;
+    AdiabatConstants adiabatConstants;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double temperature = temperatureRange(generator);
+        double pressure = pressureRange(generator);
+        double exactMixingRatio = calcMixingRatio(temperature, pressure);
+
+        //states with vapour pressure close to the air pressure do not occur in the atmosphere
+        if (exactMixingRatio < 0.1)
+        {
+            maxMixingRatioDifference = std::max(maxMixingRatioDifference, std::abs(calcMixingRatioFast(temperature, pressure) - exactMixingRatio) / exactMixingRatio);
+        }
+
+        //new adiabat every 1000 states, the way segments change during an ascent
+        double gamma = calcGamma(0.001 * (i / 1000 % 20));
+        double lambda = calcLambda(250.0 + (i / 1000 % 70), 90000.0, gamma);
+        maxAdiabatDifference = std::max(maxAdiabatDifference, calcRelativeDifference(calcTemperatureInAdiabatFast(pressure, gamma, lambda, adiabatConstants), calcTemperatureInAdiabat(pressure, gamma, lambda)));
+    }
+
+    bool passed = true;
+
+    passed &= reportAccuracy("fast saturation mixing ratio [relative]", maxMixingRatioDifference, 2e-5);
+    passed &= reportAccuracy("fast adiabat temperature [relative]", maxAdiabatDifference, 1e-14);
+
+    //whole 2-hour runs of the sample parcel, largest deviation of the fast trajectory from the exact one
+    std::map<std::string, std::string> parcelConfiguration = {
+        { "output_filename", "output/accuracy.output" }, { "timestep", "0.1" }, { "period", "2" },
+        { "pseudoadiabatic_scheme", "2" }, { "no_moisture_trsh", "0.00001" }, { "init_velocity", "0.0" },
+        { "init_height", "100" }, { "init_temp", "33" }, { "init_dewpoint", "19" } };
+    std::map<std::string, std::string> modelConfiguration = { { "dynamic_scheme", "2" }, { "adaptive_tolerance", "1e-6" } };
+
+    const std::vector<std::pair<std::string, std::string>> dynamicSchemes = { { "1", "finite difference" }, { "2", "Runge-Kutta" }, { "3", "adaptive Runge-Kutta" } };
+
+    for (const std::string profile : { "12374_20170801_12z.profile", "10393_20200619_12z.profile" })
+    {
+        const Environment environment("input/" + profile);
+
+        for (const auto& [schemeID, schemeName] : dynamicSchemes)
+        {
+            modelConfiguration["dynamic_scheme"] = schemeID;
+            std::string name = "fast " + schemeName + " " + profile.substr(0, profile.find('_'));
+
+            //the adaptive scheme takes a different sequence of steps after any small change, so instead of its trajectory
+            //the quantities of the whole ascent are compared, within limits below the error of fixed-step Runge-Kutta
+            //at this timestep (about 9 m, 9 J/kg and 0.12 m/s on 12374)
+            if (schemeID == "3")
+            {
+                parcelConfiguration["output_mode"] = "summary";
+
+                parcelConfiguration["thermo_precision"] = "exact";
+                ParcelSummary exact = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+                parcelConfiguration["thermo_precision"] = "fast";
+                ParcelSummary fast = runSimulation(environment, modelConfiguration, parcelConfiguration).getSummary();
+
+                parcelConfiguration.erase("output_mode");
+
+                passed &= reportAccuracy(name + " cloud top [m]", std::abs(fast.cloudTopHeight - exact.cloudTopHeight), 5.0);
+                passed &= reportAccuracy(name + " CAPE [J/kg]", std::abs(fast.cape - exact.cape), 5.0);
+                passed &= reportAccuracy(name + " max velocity [m/s]", std::abs(fast.maxVelocity - exact.maxVelocity), 0.1);
+                continue;
+            }
+
+            parcelConfiguration["thermo_precision"] = "exact";
+            Parcel exact = runSimulation(environment, modelConfiguration, parcelConfiguration);
+
+            parcelConfiguration["thermo_precision"] = "fast";
+            Parcel fast = runSimulation(environment, modelConfiguration, parcelConfiguration);
+
+            TrajectoryDeviation deviation = calcMaxDeviation(fast, exact);
+
+            passed &= reportAccuracy(name + " position [m]", deviation.position, 1.0);
+            passed &= reportAccuracy(name + " velocity [m/s]", deviation.velocity, 0.02);
+            passed &= reportAccuracy(name + " temperature [K]", deviation.temperature, 0.02);
+        }
+    }
+
+    return passed;
+}
@@ -0,0 +1,110 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//keeps benchmark results observable so the compiler cannot drop the measured work
+inline volatile double benchmarkSink = 0.0;
+
+//timed samples per benchmark after one untimed warm-up sample (--samples)
+inline size_t benchmarkSamples = 7;
+
+//time body() called once per operation and return the mean cost in ns
+template <typename Body>
+double measureNanosecondsPerOperation(Body&& body, size_t operations)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	for (size_t i = 0; i < operations; i++)
+	{
+		body(i);
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double, std::nano>(endTime - startTime).count() / operations;
+}
+
+//spread of the per-operation cost over repeated samples, in ns
+struct BenchmarkStatistics
+{
+	double median, minimum, mean, standardDeviation;
+	size_t samples;
+};
+
+inline BenchmarkStatistics calcBenchmarkStatistics(std::vector<double> sampleTimes)
+{
+	BenchmarkStatistics statistics;
+	size_t count = sampleTimes.size();
+
+	std::sort(sampleTimes.begin(), sampleTimes.end());
+
+	statistics.samples = count;
+	statistics.minimum = sampleTimes[0];
+	statistics.median = count % 2 == 1 ? sampleTimes[count / 2] : 0.5 * (sampleTimes[count / 2 - 1] + sampleTimes[count / 2]);
+	statistics.mean = 0.0;
+
+	for (double time : sampleTimes)
+	{
+		statistics.mean += time / count;
+	}
+
+	double variance = 0.0;
+
+	for (double time : sampleTimes)
+	{
+		variance += (time - statistics.mean) * (time - statistics.mean) / std::max<size_t>(count - 1, 1);
+	}
+
+	statistics.standardDeviation = std::sqrt(variance);
+
+	return statistics;
+}
+
+//measureNanosecondsPerOperation repeated benchmarkSamples times
+template <typename Body>
+BenchmarkStatistics measureRepeatedly(Body&& body, size_t operations)
+{
+	measureNanosecondsPerOperation(body, operations);
+
+	std::vector<double> sampleTimes;
+
+	for (size_t sample = 0; sample < benchmarkSamples; sample++)
+	{
+		sampleTimes.push_back(measureNanosecondsPerOperation(body, operations));
+	}
+
+	return calcBenchmarkStatistics(sampleTimes);
+}
+
+//statistics of a sample that covers several operations, e.g. a whole array
+inline BenchmarkStatistics scaleBenchmarkStatistics(BenchmarkStatistics statistics, double factor)
+{
+	statistics.median *= factor;
+	statistics.minimum *= factor;
+	statistics.mean *= factor;
+	statistics.standardDeviation *= factor;
+
+	return statistics;
+}
+
+//print one result and keep it for the JSON report and the baseline comparison
+void reportBenchmark(const std::string& name, const BenchmarkStatistics& statistics);
+
+bool writeBenchmarkReport(const std::string& fileName);
+//true when no benchmark is slower than its baseline median by more than tolerance (relative)
+bool compareWithBaseline(const std::string& fileName, double tolerance);
+
+void runThermodynamicBenchmarks();
+void runComponentBenchmarks();
+void runSectorIndexBenchmarks();
+void runOutputWriterBenchmarks();
+void runDynamicsBenchmarks();
+void runProfileParserBenchmarks();
+
+#endif
@@ -0,0 +1,65 @@
+#include "benchmark.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    //options: --samples N, --json report.json, --baseline baseline.json, --tolerance 0.15
+    std::string reportFileName, baselineFileName;
+    double tolerance = 0.15;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+
+        if (option == "--samples")
+        {
+            benchmarkSamples = std::max(std::atoi(argv[i + 1]), 1);
+        }
+        else if (option == "--json")
+        {
+            reportFileName = argv[i + 1];
+        }
+        else if (option == "--baseline")
+        {
+            baselineFileName = argv[i + 1];
+        }
+        else if (option == "--tolerance")
+        {
+            tolerance = std::atof(argv[i + 1]);
+        }
+        else
+        {
+            std::cout << "Unknown option " << option << "\n";
+            return -1;
+        }
+    }
+
+    std::cout << "Running benchmarks, median of " << benchmarkSamples << " samples\n";
+
+    runThermodynamicBenchmarks();
+    runComponentBenchmarks();
+    runSectorIndexBenchmarks();
+    runOutputWriterBenchmarks();
+    runDynamicsBenchmarks();
+    runProfileParserBenchmarks();
+
+    if (!reportFileName.empty())
+    {
+        if (!writeBenchmarkReport(reportFileName))
+        {
+            std::cout << "Cannot write " << reportFileName << "\n";
+            return -1;
+        }
+
+        std::cout << "Benchmark report in " << reportFileName << "\n";
+    }
+
+    if (!baselineFileName.empty() && !compareWithBaseline(baselineFileName, tolerance))
+    {
+        return 1;
+    }
+
+    return 0;
+}
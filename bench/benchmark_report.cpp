@@ -0,0 +1,156 @@
+#include "benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct BenchmarkRecord
+    {
+        std::string name;
+        BenchmarkStatistics statistics;
+    };
+
+    std::vector<BenchmarkRecord> benchmarkRecords;
+
+    std::string escapeJson(const std::string& text)
+    {
+        std::string escaped;
+
+        for (char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped += '\\';
+            }
+
+            escaped += character;
+        }
+
+        return escaped;
+    }
+
+    //medians by name from a report written by writeBenchmarkReport
+    bool readBaselineMedians(const std::string& fileName, std::map<std::string, double>& medians)
+    {
+        std::ifstream file(fileName);
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const std::string nameKey = "\"name\": \"";
+        const std::string medianKey = "\"median_ns\": ";
+        size_t position = 0;
+
+        while ((position = text.find(nameKey, position)) != std::string::npos)
+        {
+            size_t nameStart = position + nameKey.size();
+            size_t nameEnd = nameStart;
+            std::string name;
+
+            while (nameEnd < text.size() && text[nameEnd] != '"')
+            {
+                if (text[nameEnd] == '\\')
+                {
+                    nameEnd++;
+                }
+
+                name += text[nameEnd];
+                nameEnd++;
+            }
+
+            size_t medianStart = text.find(medianKey, nameEnd);
+
+            if (medianStart == std::string::npos)
+            {
+                return false;
+            }
+
+            medians[name] = std::strtod(text.c_str() + medianStart + medianKey.size(), nullptr);
+            position = medianStart;
+        }
+
+        return true;
+    }
+}
+
+void reportBenchmark(const std::string& name, const BenchmarkStatistics& statistics)
+{
+    double relativeSpread = statistics.median > 0.0 ? 100.0 * statistics.standardDeviation / statistics.median : 0.0;
+    std::printf("%-60s %12.2f ns/op  (min %.2f, sd %.1f%%)\n", name.c_str(), statistics.median, statistics.minimum, relativeSpread);
+
+    benchmarkRecords.push_back({ name, statistics });
+}
+
+bool writeBenchmarkReport(const std::string& fileName)
+{
+    std::ofstream file(fileName);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    file << "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < benchmarkRecords.size(); i++)
+    {
+        const BenchmarkStatistics& statistics = benchmarkRecords[i].statistics;
+        char values[256];
+
+        std::snprintf(values, sizeof(values), "\"median_ns\": %.4f, \"min_ns\": %.4f, \"mean_ns\": %.4f, \"stddev_ns\": %.4f, \"samples\": %zu",
+            statistics.median, statistics.minimum, statistics.mean, statistics.standardDeviation, statistics.samples);
+
+        file << "    { \"name\": \"" << escapeJson(benchmarkRecords[i].name) << "\", " << values << " }" << (i + 1 < benchmarkRecords.size() ? "," : "") << "\n";
+    }
+
+    file << "  ]\n}\n";
+
+    return file.good();
+}
+
+bool compareWithBaseline(const std::string& fileName, double tolerance)
+{
+    std::map<std::string, double> baselineMedians;
+
+    if (!readBaselineMedians(fileName, baselineMedians))
+    {
+        std::cout << "Cannot read benchmark baseline " << fileName << "\n";
+        return false;
+    }
+
+    size_t compared = 0, regressions = 0;
+
+    std::cout << "Comparison with " << fileName << " (tolerance " << tolerance * 100.0 << "%)\n";
+
+    for (const BenchmarkRecord& record : benchmarkRecords)
+    {
+        auto baseline = baselineMedians.find(record.name);
+
+        if (baseline == baselineMedians.end() || baseline->second <= 0.0)
+        {
+            continue;
+        }
+
+        double ratio = record.statistics.median / baseline->second;
+        compared++;
+
+        if (ratio > 1.0 + tolerance)
+        {
+            std::printf("  REGRESSION %-60s %10.2f -> %10.2f ns/op (%+.1f%%)\n", record.name.c_str(), baseline->second, record.statistics.median, 100.0 * (ratio - 1.0));
+            regressions++;
+        }
+    }
+
+    std::cout << compared << " benchmarks compared, " << regressions << " regressions\n";
+
+    return regressions == 0;
+}
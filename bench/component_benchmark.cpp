@@ -0,0 +1,153 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/pseudoadiabatic_scheme.h"
+#include "../src/pseudoadiabat_table.h"
+#include "../src/thermodynamic_calc.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    template <class Pseudoadiabat>
+    void benchmarkPseudoadiabat(const std::string& name, Pseudoadiabat scheme, const std::vector<Parcel::Slice>& slices, const std::vector<double>& wetBulbThetas)
+    {
+        //pressure step of a 0.1 s timestep of a fast parcel
+        const double deltaPressure = -50.0;
+
+        BenchmarkStatistics time = measureRepeatedly([&](size_t i)
+            {
+                size_t j = i % slices.size();
+                benchmarkSink = benchmarkSink + scheme.calculateCurrentPseudoadiabaticTemperature(slices[j], deltaPressure, wetBulbThetas[j]);
+            }, 200000);
+
+        reportBenchmark("pseudoadiabat " + name, time);
+    }
+}
+
+void runComponentBenchmarks()
+{
+    const size_t count = 4096;
+    const size_t operations = 1000000;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> temperatureRange(220.0, 305.0);
+    std::uniform_real_distribution<double> pressureRange(20000.0, 100000.0);
+
+    std::vector<double> temperature(count), pressure(count), mixingRatio(count), gamma(count), wetBulbTheta(count);
+    std::vector<Parcel::Slice> slices(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        temperature[i] = temperatureRange(generator);
+        pressure[i] = pressureRange(generator);
+        mixingRatio[i] = calcMixingRatio(temperature[i], pressure[i]);
+        gamma[i] = calcGamma(mixingRatio[i]);
+
+        slices[i].temperature = temperature[i];
+        slices[i].pressure = pressure[i];
+        slices[i].mixingRatio = mixingRatio[i];
+        slices[i].mixingRatioSaturated = mixingRatio[i];
+        wetBulbTheta[i] = calcWBPotentialTemperature(temperature[i], mixingRatio[i], mixingRatio[i], pressure[i]);
+    }
+
+    //scalar thermodynamic functions not covered by the array comparison
+    reportBenchmark("calcGamma", measureRepeatedly([&](size_t i)
+        {
+            benchmarkSink = benchmarkSink + calcGamma(mixingRatio[i % count]);
+        }, operations));
+
+    reportBenchmark("calcLambda", measureRepeatedly([&](size_t i)
+        {
+            size_t j = i % count;
+            benchmarkSink = benchmarkSink + calcLambda(temperature[j], pressure[j], gamma[j]);
+        }, operations));
+
+    reportBenchmark("calcBouyancyForce", measureRepeatedly([&](size_t i)
+        {
+            size_t j = i % count;
+            benchmarkSink = benchmarkSink + calcBouyancyForce(temperature[j], temperature[count - 1 - j]);
+        }, operations));
+
+    //exact and thermo_precision=fast versions of the functions evaluated every dynamic step
+    reportBenchmark("calcMixingRatio exact", measureRepeatedly([&](size_t i)
+        {
+            size_t j = i % count;
+            benchmarkSink = benchmarkSink + calcMixingRatio(temperature[j], pressure[j]);
+        }, operations));
+
+    reportBenchmark("calcMixingRatio fast", measureRepeatedly([&](size_t i)
+        {
+            size_t j = i % count;
+            benchmarkSink = benchmarkSink + calcMixingRatioFast(temperature[j], pressure[j]);
+        }, operations));
+
+    //one adiabat per segment of the ascent, as in the dynamics
+    const double adiabatGamma = gamma[0];
+    const double adiabatLambda = calcLambda(temperature[0], pressure[0], adiabatGamma);
+    AdiabatConstants adiabatConstants;
+
+    reportBenchmark("calcTemperatureInAdiabat exact", measureRepeatedly([&](size_t i)
+        {
+            benchmarkSink = benchmarkSink + calcTemperatureInAdiabat(pressure[i % count], adiabatGamma, adiabatLambda);
+        }, operations));
+
+    reportBenchmark("calcTemperatureInAdiabat fast", measureRepeatedly([&](size_t i)
+        {
+            benchmarkSink = benchmarkSink + calcTemperatureInAdiabatFast(pressure[i % count], adiabatGamma, adiabatLambda, adiabatConstants);
+        }, operations));
+
+    //every pseudoadiabatic scheme from random saturated states
+    benchmarkPseudoadiabat("finite difference", FiniteDifferencePseudoadiabat(), slices, wetBulbTheta);
+    benchmarkPseudoadiabat("Runge-Kutta", RungeKuttaPseudoadiabat(), slices, wetBulbTheta);
+    benchmarkPseudoadiabat("GEP numerical", NumericalPseudoadiabat(), slices, wetBulbTheta);
+    benchmarkPseudoadiabat("table", TablePseudoadiabat(PseudoadiabatTable::getInstance("")), slices, wetBulbTheta);
+
+    //location updates and lookups along an ascent with parcel-like steps
+    for (const std::string profile : { "12374_20170801_12z.profile", "10393_20200619_12z.profile" })
+    {
+        const Environment environment("input/" + profile);
+        const std::string name = profile.substr(0, profile.find('_'));
+        const double stepHeight = 2.0;
+        const size_t ascentSteps = static_cast<size_t>((environment.highestPoint - environment.height[0]) / stepHeight) - 1;
+
+        Environment::Location location;
+
+        reportBenchmark("Location::updateSector " + name + " ascent", measureRepeatedly([&](size_t i)
+            {
+                location.position = environment.height[0] + ((i % ascentSteps) * stepHeight);
+                location.updateSector(environment);
+                benchmarkSink = benchmarkSink + location.sector.lowerBoundary;
+            }, operations));
+
+        std::vector<Environment::Location> locations(count);
+        std::uniform_real_distribution<double> heightRange(environment.height[0], environment.highestPoint);
+
+        for (Environment::Location& randomLocation : locations)
+        {
+            randomLocation.position = heightRange(generator);
+            randomLocation.updateSector(environment);
+        }
+
+        reportBenchmark("Environment::getPressureAtLocation " + name, measureRepeatedly([&](size_t i)
+            {
+                benchmarkSink = benchmarkSink + environment.getPressureAtLocation(locations[i % count]);
+            }, operations));
+
+        reportBenchmark("Environment::getTemperatureAtLocation " + name, measureRepeatedly([&](size_t i)
+            {
+                benchmarkSink = benchmarkSink + environment.getTemperatureAtLocation(locations[i % count]);
+            }, operations));
+
+        reportBenchmark("Environment::getDewpointAtLocation " + name, measureRepeatedly([&](size_t i)
+            {
+                benchmarkSink = benchmarkSink + environment.getDewpointAtLocation(locations[i % count]);
+            }, operations));
+
+        reportBenchmark("Environment::getVirtualTemperatureAtLocation " + name, measureRepeatedly([&](size_t i)
+            {
+                benchmarkSink = benchmarkSink + environment.getVirtualTemperatureAtLocation(locations[i % count]);
+            }, operations));
+    }
+}
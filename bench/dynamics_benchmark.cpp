@@ -0,0 +1,124 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/dynamic_scheme.h"
+#include "../src/pseudoadiabatic_scheme.h"
+#include "../src/thermodynamic_calc.h"
+#include "benchmark.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    //per-step scheme selection used before the dynamics were specialised, kept as the reference
+    std::unique_ptr<PseudoAdiabaticScheme> chooseSchemeEveryStep(const std::map<std::string, std::string>& parcelConfiguration)
+    {
+        size_t pseudoadiabaticSchemeID = std::stoi(parcelConfiguration.at("pseudoadiabatic_scheme"));
+
+        if (pseudoadiabaticSchemeID == 1)
+        {
+            return std::make_unique<FiniteDifferencePseudoadiabat>();
+        }
+        else if (pseudoadiabaticSchemeID == 2)
+        {
+            return std::make_unique<RungeKuttaPseudoadiabat>();
+        }
+        else if (pseudoadiabaticSchemeID == 3)
+        {
+            return std::make_unique<NumericalPseudoadiabat>();
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    Parcel::Slice getSaturatedSlice(double temperature, double pressure)
+    {
+        Parcel::Slice slice;
+        slice.temperature = temperature;
+        slice.pressure = pressure;
+        slice.mixingRatioSaturated = calcMixingRatio(temperature, pressure);
+        slice.mixingRatio = slice.mixingRatioSaturated;
+
+        return slice;
+    }
+}
+
+void runDynamicsBenchmarks()
+{
+    const std::map<std::string, std::string> parcelConfiguration = {
+        { "output_filename", "output/benchmark.output" }, { "timestep", "0.1" }, { "period", "2" },
+        { "pseudoadiabatic_scheme", "2" }, { "no_moisture_trsh", "0.00001" }, { "init_velocity", "0.0" },
+        { "init_height", "100" }, { "init_temp", "33" }, { "init_dewpoint", "19" } };
+    const std::map<std::string, std::string> modelConfiguration = { { "dynamic_scheme", "2" } };
+
+    //the pseudoadiabat part of one Runge-Kutta step: three scheme evaluations
+    const size_t operations = 200000;
+    const Parcel::Slice slice = getSaturatedSlice(290.0, 85000.0);
+    const double wetBulbTheta = calcWBPotentialTemperature(slice.temperature, slice.mixingRatio, slice.mixingRatioSaturated, slice.pressure);
+
+    BenchmarkStatistics legacyTime = measureRepeatedly([&](size_t i)
+        {
+            std::unique_ptr<PseudoAdiabaticScheme> scheme = chooseSchemeEveryStep(parcelConfiguration);
+            double deltaPressure = -1.0 - (i & 7);
+
+            benchmarkSink = benchmarkSink + scheme->calculateCurrentPseudoadiabaticTemperature(slice, deltaPressure, wetBulbTheta)
+                + scheme->calculateCurrentPseudoadiabaticTemperature(slice, 0.5 * deltaPressure, wetBulbTheta)
+                + scheme->calculateCurrentPseudoadiabaticTemperature(slice, 2.0 * deltaPressure, wetBulbTheta);
+        }, operations);
+
+    RungeKuttaPseudoadiabat scheme;
+
+    BenchmarkStatistics specialisedTime = measureRepeatedly([&](size_t i)
+        {
+            double deltaPressure = -1.0 - (i & 7);
+
+            benchmarkSink = benchmarkSink + scheme.calculateCurrentPseudoadiabaticTemperature(slice, deltaPressure, wetBulbTheta)
+                + scheme.calculateCurrentPseudoadiabaticTemperature(slice, 0.5 * deltaPressure, wetBulbTheta)
+                + scheme.calculateCurrentPseudoadiabaticTemperature(slice, 2.0 * deltaPressure, wetBulbTheta);
+        }, operations);
+
+    reportBenchmark("pseudoadiabat per RK step, scheme chosen every step", legacyTime);
+    reportBenchmark("pseudoadiabat per RK step, scheme fixed at startup", specialisedTime);
+
+    //whole 2-hour runs of the sample parcel with every dynamic scheme on both sample profiles, in double and in float
+    const std::vector<std::pair<std::string, std::string>> dynamicSchemes = { { "1", "finite difference" }, { "2", "Runge-Kutta" }, { "3", "adaptive Runge-Kutta" }, { "4", "Adams-Bashforth-Moulton" } };
+
+    for (const std::string profile : { "12374_20170801_12z.profile", "10393_20200619_12z.profile" })
+    {
+        const Environment environment("input/" + profile);
+
+        for (const auto& [schemeID, schemeName] : dynamicSchemes)
+        {
+            for (const std::string floatingPoint : { "double", "float" })
+            {
+                std::map<std::string, std::string> runModelConfiguration = modelConfiguration;
+                runModelConfiguration["dynamic_scheme"] = schemeID;
+
+                std::map<std::string, std::string> runParcelConfiguration = parcelConfiguration;
+                runParcelConfiguration["floating_point"] = floatingPoint;
+
+                std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(runModelConfiguration, runParcelConfiguration, environment);
+                Parcel parcel(environment, runParcelConfiguration);
+                size_t steps = 0;
+
+                BenchmarkStatistics runTime = measureRepeatedly([&](size_t)
+                    {
+                        Parcel result = dynamicScheme->runSimulationOn(parcel);
+                        steps = result.getStoredSteps();
+                        benchmarkSink = benchmarkSink + result.position[result.currentTimeStep];
+                    }, 1);
+
+                //one step of the scheme, averaged over the run
+                std::string name = schemeName + (floatingPoint == "float" ? " float " : " ") + profile.substr(0, profile.find('_'));
+                reportBenchmark(name + " run", runTime);
+                reportBenchmark(name + " step", scaleBenchmarkStatistics(runTime, 1.0 / steps));
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "../src/environment.h"
+#include "../src/parcel.h"
+#include "../src/dynamic_scheme.h"
+#include "../src/output.h"
+#include "benchmark.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace
+{
+    //iostream writer used before the to_chars writer, kept as the reference
+    void writeWithStream(const std::string& fileName, const Parcel& parcel)
+    {
+        std::ofstream output(fileName);
+
+        output << std::fixed << std::setprecision(5);
+
+        output << "position; velocity; pressure; temperature; virtual_temperature; mixing_ratio; saturation_mixing_ratio;" << "\n";
+
+        for (size_t i = 0; i < parcel.getStoredSteps(); i++)
+        {
+            output << parcel.position[i] << "; "
+                << parcel.velocity[i] << "; "
+                << parcel.pressure[i] << "; "
+                << parcel.temperature[i] << "; "
+                << parcel.temperatureVirtual[i] << "; "
+                << parcel.mixingRatio[i] << "; "
+                << parcel.mixingRatioSaturated[i] << ";" << "\n";
+        }
+
+        output.close();
+    }
+
+    std::string readFile(const std::string& fileName)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+}
+
+void runOutputWriterBenchmarks()
+{
+    //full 2-hour trajectory of the sample configuration
+    const std::map<std::string, std::string> parcelConfiguration = {
+        { "output_filename", "output/benchmark.output" }, { "timestep", "0.1" }, { "period", "2" },
+        { "pseudoadiabatic_scheme", "2" }, { "no_moisture_trsh", "0.00001" }, { "init_velocity", "0.0" },
+        { "init_height", "100" }, { "init_temp", "33" }, { "init_dewpoint", "19" } };
+
+    const Environment environment("input/12374_20170801_12z.profile");
+    Parcel parcel(environment, parcelConfiguration);
+    RungeKuttaDynamics<RungeKuttaPseudoadiabat, double> dynamics(environment, RungeKuttaPseudoadiabat());
+    parcel = dynamics.runSimulationOn(parcel);
+
+    const std::string streamFile = "output/benchmark_stream.output";
+    const std::string blockFile = "output/benchmark_to_chars.output";
+    //one whole file per operation, reported per row
+    BenchmarkStatistics streamTime = measureRepeatedly([&](size_t) { writeWithStream(streamFile, parcel); }, 1);
+    BenchmarkStatistics blockTime = measureRepeatedly([&](size_t) { writeTextOutput(blockFile, getOutputTableOf(parcel)); }, 1);
+
+    std::string name = "text output " + std::to_string(parcel.getStoredSteps()) + " rows";
+    reportBenchmark(name + " iostream writer", scaleBenchmarkStatistics(streamTime, 1.0 / parcel.getStoredSteps()));
+    reportBenchmark(name + " to_chars writer", scaleBenchmarkStatistics(blockTime, 1.0 / parcel.getStoredSteps()));
+    std::printf("  whole file: iostream %.2f ms, to_chars %.2f ms\n", streamTime.median / 1e6, blockTime.median / 1e6);
+
+    if (readFile(streamFile) != readFile(blockFile))
+    {
+        std::cout << "  outputs of the two writers differ\n";
+    }
+
+    std::remove(streamFile.c_str());
+    std::remove(blockFile.c_str());
+}
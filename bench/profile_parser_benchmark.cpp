@@ -0,0 +1,93 @@
+#include "../src/profile_reader.h"
+#include "benchmark.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    //getline and stringstream parser used before the memory-mapped reader, kept as the reference
+    void readProfileWithStreams(const std::string& fileName, std::vector<double>& height, std::vector<double>& pressure, std::vector<double>& temperature, std::vector<double>& dewpoint)
+    {
+        std::ifstream file(fileName);
+        std::string line;
+
+        getline(file, line);
+        getline(file, line);
+
+        while (getline(file, line))
+        {
+            std::stringstream lineStream(line);
+            std::string var;
+
+            getline(lineStream, var, ';');
+            height.push_back(stod(var));
+            getline(lineStream, var, ';');
+            pressure.push_back(stod(var));
+            getline(lineStream, var, ';');
+            temperature.push_back(stod(var));
+            getline(lineStream, var, ';');
+            dewpoint.push_back(stod(var));
+        }
+    }
+}
+
+void runProfileParserBenchmarks()
+{
+    const size_t repetitions = 10;
+
+    for (const std::string fileName : { "input/12374_20170801_12z.profile", "input/10393_20200619_12z.profile" })
+    {
+        std::vector<double> height, pressure, temperature, dewpoint;
+        std::vector<double> referenceHeight, referencePressure, referenceTemperature, referenceDewpoint;
+
+        BenchmarkStatistics streamTime = measureRepeatedly([&](size_t)
+            {
+                referenceHeight.clear();
+                referencePressure.clear();
+                referenceTemperature.clear();
+                referenceDewpoint.clear();
+                readProfileWithStreams(fileName, referenceHeight, referencePressure, referenceTemperature, referenceDewpoint);
+            }, repetitions);
+
+        BenchmarkStatistics mappedTime = measureRepeatedly([&](size_t)
+            {
+                readProfileFile(fileName, height, pressure, temperature, dewpoint);
+            }, repetitions);
+
+        std::string name = "profile read, " + std::to_string(height.size()) + " levels,";
+        reportBenchmark(name + " getline", streamTime);
+        reportBenchmark(name + " mmap + from_chars", mappedTime);
+
+        if (height != referenceHeight || pressure != referencePressure || temperature != referenceTemperature || dewpoint != referenceDewpoint)
+        {
+            std::printf("  values of the two parsers differ\n");
+        }
+    }
+
+    //the same profiles as columns of a packed archive, mapped once and read without parsing
+    const std::vector<std::string> profileFileNames = { "input/12374_20170801_12z.profile", "input/10393_20200619_12z.profile" };
+    writeProfileArchive("output/benchmark.archive", profileFileNames, false);
+    const ProfileArchive archive("output/benchmark.archive");
+
+    for (size_t column = 0; column < archive.size(); column++)
+    {
+        std::vector<double> height, pressure, temperature, dewpoint;
+        std::vector<double> referenceHeight, referencePressure, referenceTemperature, referenceDewpoint;
+        readProfileFile(profileFileNames[column], referenceHeight, referencePressure, referenceTemperature, referenceDewpoint);
+
+        BenchmarkStatistics archiveTime = measureRepeatedly([&](size_t)
+            {
+                archive.readColumn(column, height, pressure, temperature, dewpoint);
+            }, repetitions);
+
+        reportBenchmark("profile read, " + std::to_string(height.size()) + " levels, archive column", archiveTime);
+
+        if (height != referenceHeight || pressure != referencePressure || temperature != referenceTemperature || dewpoint != referenceDewpoint)
+        {
+            std::printf("  values of the archive and the parser differ\n");
+        }
+    }
+}
@@ -0,0 +1,179 @@
+#include "../src/environment.h"
+#include "benchmark.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    //linear neighbour walk used by Location::updateSector before the height index, kept as the reference
+    Sector walkToSector(const std::vector<double>& height, double position, Sector sector)
+    {
+        size_t nearestPoint;
+
+        double distToUpper = std::abs(position - height[sector.upperBoundary]);
+        double distToLower = std::abs(position - height[sector.lowerBoundary]);
+
+        if (distToLower == distToUpper)
+        {
+            return sector;
+        }
+        else if (distToLower < distToUpper)
+        {
+            if (sector.lowerBoundary == 0)
+            {
+                sector.upperBoundary = 1;
+                return sector;
+            }
+
+            nearestPoint = sector.lowerBoundary;
+            double dist = distToLower;
+            double newDist = std::abs(position - height[nearestPoint - 1]);
+
+            while (newDist < dist)
+            {
+                dist = newDist;
+                nearestPoint--;
+
+                if (nearestPoint > 0)
+                {
+                    newDist = std::abs(position - height[nearestPoint - 1]);
+                }
+                else
+                {
+                    sector.lowerBoundary = 0;
+                    sector.upperBoundary = 1;
+                    return sector;
+                }
+            }
+        }
+        else
+        {
+            if (sector.upperBoundary == (height.size() - 1))
+            {
+                sector.lowerBoundary = height.size() - 2;
+                return sector;
+            }
+
+            nearestPoint = sector.upperBoundary;
+            double dist = distToUpper;
+            double newDist = std::abs(position - height[nearestPoint + 1]);
+
+            while (newDist < dist)
+            {
+                dist = newDist;
+                nearestPoint++;
+
+                if (nearestPoint < (height.size() - 1))
+                {
+                    newDist = std::abs(position - height[nearestPoint + 1]);
+                }
+                else
+                {
+                    sector.lowerBoundary = height.size() - 2;
+                    sector.upperBoundary = height.size() - 1;
+                    return sector;
+                }
+            }
+        }
+
+        if (position - height[nearestPoint] >= 0)
+        {
+            sector.lowerBoundary = nearestPoint;
+            sector.upperBoundary = nearestPoint + 1;
+        }
+        else
+        {
+            sector.lowerBoundary = nearestPoint - 1;
+            sector.upperBoundary = nearestPoint;
+        }
+
+        return sector;
+    }
+
+    void benchmarkQueries(const std::string& label, const Environment& environment, const std::vector<double>& positions)
+    {
+        Sector walkedSector;
+        size_t mismatches = 0;
+
+        BenchmarkStatistics walkTime = measureRepeatedly([&](size_t i)
+            {
+                walkedSector = walkToSector(environment.height, positions[i], walkedSector);
+                benchmarkSink = benchmarkSink + walkedSector.lowerBoundary;
+            }, positions.size());
+
+        BenchmarkStatistics indexTime = measureRepeatedly([&](size_t i)
+            {
+                Sector sector = environment.findSector(positions[i]);
+                benchmarkSink = benchmarkSink + sector.lowerBoundary;
+            }, positions.size());
+
+        //both lookups must bracket the position the same way
+        walkedSector = Sector();
+
+        for (double position : positions)
+        {
+            walkedSector = walkToSector(environment.height, position, walkedSector);
+            Sector sector = environment.findSector(position);
+
+            if (environment.height[sector.lowerBoundary] != environment.height[walkedSector.lowerBoundary])
+            {
+                mismatches++;
+            }
+        }
+
+        reportBenchmark(label + " linear walk", walkTime);
+        reportBenchmark(label + " height index", indexTime);
+
+        if (mismatches > 0)
+        {
+            std::cout << "  " << mismatches << " lookups disagree with the linear walk\n";
+        }
+    }
+}
+
+void runSectorIndexBenchmarks()
+{
+    const std::vector<std::string> profiles = { "input/12374_20170801_12z.profile", "input/10393_20200619_12z.profile" };
+    const size_t queryCount = 100000;
+
+    for (const std::string& profile : profiles)
+    {
+        const Environment environment(profile);
+
+        //the linear walk cannot step across repeated levels, so queries stay below the first one
+        double topHeight = environment.highestPoint;
+
+        for (size_t i = 0; i + 1 < environment.height.size(); i++)
+        {
+            if (environment.height[i + 1] == environment.height[i])
+            {
+                topHeight = environment.height[i];
+                break;
+            }
+        }
+
+        std::mt19937_64 generator(12345);
+        std::uniform_real_distribution<double> anyHeight(environment.height[0], topHeight);
+
+        //parcel-like ascent: small moves between consecutive queries
+        std::vector<double> ascent(queryCount);
+        for (size_t i = 0; i < queryCount; i++)
+        {
+            ascent[i] = environment.height[0] + (topHeight - environment.height[0]) * i / queryCount;
+        }
+
+        //large jumps, as with long timesteps or fast parcels
+        std::vector<double> jumps(queryCount);
+        for (double& position : jumps)
+        {
+            position = anyHeight(generator);
+        }
+
+        std::string name = profile.substr(profile.find_last_of('/') + 1, 5);
+        benchmarkQueries("findSector " + name + " ascent", environment, ascent);
+        benchmarkQueries("findSector " + name + " random", environment, jumps);
+    }
+}
@@ -0,0 +1,69 @@
+#include "../src/thermodynamic_calc.h"
+#include "benchmark.h"
+#include <random>
+#include <string>
+#include <vector>
+
+void runThermodynamicBenchmarks()
+{
+    //scalar calls in a loop against one call of the array kernel over the same inputs
+    const size_t count = 4096;
+    const size_t repetitions = 100;
+
+    std::mt19937_64 generator(2020);
+    std::uniform_real_distribution<double> temperatureRange(200.0, 310.0);
+    std::uniform_real_distribution<double> pressureRange(10000.0, 102000.0);
+
+    std::vector<double> temperature(count), pressure(count), mixingRatio(count), satMixingRatio(count), gamma(count), lambda(count), result(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        temperature[i] = temperatureRange(generator);
+        pressure[i] = pressureRange(generator);
+        satMixingRatio[i] = calcMixingRatio(temperature[i], pressure[i]);
+        mixingRatio[i] = 0.5 * satMixingRatio[i];
+        gamma[i] = calcGamma(mixingRatio[i]);
+        lambda[i] = calcLambda(temperature[i], pressure[i], gamma[i]);
+    }
+
+    auto compareKernels = [&](const std::string& name, auto scalarBody, auto arrayBody)
+    {
+        BenchmarkStatistics scalarTime = measureRepeatedly([&](size_t)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    result[i] = scalarBody(i);
+                }
+                benchmarkSink = benchmarkSink + result[count - 1];
+            }, repetitions);
+
+        BenchmarkStatistics arrayTime = measureRepeatedly([&](size_t)
+            {
+                arrayBody();
+                benchmarkSink = benchmarkSink + result[count - 1];
+            }, repetitions);
+
+        reportBenchmark(name + " scalar", scaleBenchmarkStatistics(scalarTime, 1.0 / count));
+        reportBenchmark(name + " array", scaleBenchmarkStatistics(arrayTime, 1.0 / count));
+    };
+
+    compareKernels("calcVapourPressure",
+        [&](size_t i) { return calcVapourPressure(temperature[i], pressure[i]); },
+        [&]() { calcVapourPressure(temperature.data(), pressure.data(), result.data(), count); });
+
+    compareKernels("calcMixingRatio",
+        [&](size_t i) { return calcMixingRatio(temperature[i], pressure[i]); },
+        [&]() { calcMixingRatio(temperature.data(), pressure.data(), result.data(), count); });
+
+    compareKernels("calcVirtualTemperature",
+        [&](size_t i) { return calcVirtualTemperature(temperature[i], mixingRatio[i]); },
+        [&]() { calcVirtualTemperature(temperature.data(), mixingRatio.data(), result.data(), count); });
+
+    compareKernels("calcTemperatureInAdiabat",
+        [&](size_t i) { return calcTemperatureInAdiabat(pressure[i], gamma[i], lambda[i]); },
+        [&]() { calcTemperatureInAdiabat(pressure.data(), gamma.data(), lambda.data(), result.data(), count); });
+
+    compareKernels("calcWBPotentialTemperature",
+        [&](size_t i) { return calcWBPotentialTemperature(temperature[i], mixingRatio[i], satMixingRatio[i], pressure[i]); },
+        [&]() { calcWBPotentialTemperature(temperature.data(), mixingRatio.data(), satMixingRatio.data(), pressure.data(), result.data(), count); });
+}
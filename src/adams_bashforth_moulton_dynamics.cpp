@@ -0,0 +1,250 @@
+#include "thermodynamic_calc.h"
+#include "environment.h"
+#include "parcel.h"
+#include "dynamic_scheme.h"
+#include "pseudoadiabatic_scheme.h"
+#include "instrumentation.h"
+#include <algorithm>
+
+template <class Pseudoadiabat, class Real>
+AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::AdamsBashforthMoultonDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme) :
+	sourceEnvironment(environment),
+	convertedEnvironment(environment),
+	environment(convertedEnvironment.get()),
+	pseudoadiabaticScheme(pseudoadiabaticScheme),
+	phase(Phase::moistAdiabat),
+	gamma(0.0),
+	lambda(0.0),
+	wetBulbPotentialTemp(0.0),
+	velocityHistory(),
+	bouyancyHistory(),
+	historySize(0)
+{
+}
+
+template <class Pseudoadiabat, class Real>
+Parcel AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::runSimulationOn(Parcel& passedParcel)
+{
+	parcel = convertParcel(passedParcel, environment);
+
+	while (isParcelWithinBounds())
+	{
+		ascentAlongMoistAdiabat();
+		ascentAlongPseudoAdiabat();
+	}
+
+	return convertParcel(parcel, sourceEnvironment);
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::ascentAlongMoistAdiabat()
+{
+	INSTRUMENT_PHASE(moistAdiabat);
+
+	//calculate ascent constants
+	gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
+	lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
+
+	if (!isParcelWithinBounds())
+	{
+		return;
+	}
+
+	//integrate until the parcel becomes saturated
+	phase = Phase::moistAdiabat;
+	integratePhase();
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::ascentAlongPseudoAdiabat()
+{
+	INSTRUMENT_PHASE(pseudoAdiabat);
+
+	//calculate wet-bulb potential temperature for pseudoadiabatic ascent
+	wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
+
+	if (parcel.mixingRatio[parcel.currentTimeStep] <= parcel.noMoistureTreshold || parcel.velocity[parcel.currentTimeStep] <= 0)
+	{
+		return;
+	}
+
+	if (!isParcelWithinBounds())
+	{
+		return;
+	}
+
+	//integrate until the point of no moisture or until the parcel starts to descend
+	phase = Phase::pseudoAdiabat;
+	integratePhase();
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::integratePhase()
+{
+	//buoyancy changes its form between the phases, so history from the previous phase is dropped
+	historySize = 0;
+	pushHistory();
+
+	do
+	{
+		stepStartSlice = parcel.getSlice(0);
+
+		if (historySize < historySteps)
+		{
+			makeRungeKuttaTimeStep();
+		}
+		else
+		{
+			makeMultistepTimeStep();
+		}
+
+		//update parcel properties
+		parcel.currentTimeStep++;
+		INSTRUMENT_COUNT(timesteps);
+		parcel.updateCurrentDynamicsAndPressure();
+
+		if (!completeTimeStep())
+		{
+			return;
+		}
+
+		pushHistory();
+	} while (isParcelWithinBounds());
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::makeRungeKuttaTimeStep()
+{
+	INSTRUMENT_TIMER(stepTime);
+
+	//the classic 4th order step of RungeKuttaDynamics, fills the history until the multistep formulas can be used
+	Real C0 = velocityHistory[0];
+	Real K0 = bouyancyHistory[0];
+
+	Real C1 = C0 + (Real(0.5) * parcel.timeDelta * K0);
+	Real K1 = calcBouyancyAtPosition(parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C0));
+
+	Real C2 = C0 + (Real(0.5) * parcel.timeDelta * K1);
+	Real K2 = calcBouyancyAtPosition(parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C1));
+
+	Real C3 = C0 + (parcel.timeDelta * K2);
+	Real K3 = calcBouyancyAtPosition(parcel.currentLocation.position + (parcel.timeDelta * C2));
+
+	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (C0 + Real(2.0) * C1 + Real(2.0) * C2 + C3));
+	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (K0 + Real(2.0) * K1 + Real(2.0) * K2 + K3));
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::makeMultistepTimeStep()
+{
+	INSTRUMENT_TIMER(stepTime);
+
+	//predict with the 4-step Adams-Bashforth formula, correct once with the 3-step Adams-Moulton formula (PECE)
+	const Real* w = velocityHistory;
+	const Real* B = bouyancyHistory;
+	Real stepFactor = parcel.timeDelta / Real(24.0);
+
+	Real predictedPosition = parcel.position[parcel.currentTimeStep] + stepFactor * (Real(55.0) * w[0] - Real(59.0) * w[1] + Real(37.0) * w[2] - Real(9.0) * w[3]);
+	Real predictedVelocity = parcel.velocity[parcel.currentTimeStep] + stepFactor * (Real(55.0) * B[0] - Real(59.0) * B[1] + Real(37.0) * B[2] - Real(9.0) * B[3]);
+	Real predictedBouyancy = calcBouyancyAtPosition(predictedPosition);
+
+	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + stepFactor * (Real(9.0) * predictedVelocity + Real(19.0) * w[0] - Real(5.0) * w[1] + w[2]);
+	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + stepFactor * (Real(9.0) * predictedBouyancy + Real(19.0) * B[0] - Real(5.0) * B[1] + B[2]);
+}
+
+template <class Pseudoadiabat, class Real>
+void AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::pushHistory()
+{
+	//buoyancy of the completed timestep comes from the parcel thermodynamics already calculated for the output
+	INSTRUMENT_COUNT(stageEvaluations);
+
+	std::copy_backward(velocityHistory, velocityHistory + historySteps - 1, velocityHistory + historySteps);
+	std::copy_backward(bouyancyHistory, bouyancyHistory + historySteps - 1, bouyancyHistory + historySteps);
+
+	velocityHistory[0] = parcel.velocity[parcel.currentTimeStep];
+	bouyancyHistory[0] = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], environment.getVirtualTemperatureAtLocation(parcel.currentLocation));
+	historySize = std::min(historySize + 1, historySteps);
+}
+
+template <class Pseudoadiabat, class Real>
+Real AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::calcBouyancyAtPosition(Real position)
+{
+	INSTRUMENT_COUNT(stageEvaluations);
+
+	typename BasicEnvironment<Real>::Location location = parcel.currentLocation;
+	location.position = position;
+	location.updateSector(environment);
+
+	Real pressure = environment.getPressureAtLocation(location);
+	Real temperatureVirtual;
+
+	if (phase == Phase::moistAdiabat)
+	{
+		Real temperature = parcel.getTemperatureInAdiabat(pressure, gamma, lambda);
+		temperatureVirtual = calcVirtualTemperature(temperature, stepStartSlice.mixingRatio);
+	}
+	else
+	{
+		Real temperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepStartSlice, pressure - stepStartSlice.pressure, wetBulbPotentialTemp);
+		Real mixingRatio = parcel.getMixingRatio(temperature, pressure);
+		temperatureVirtual = calcVirtualTemperature(temperature, mixingRatio);
+	}
+
+	return calcBouyancyForce(temperatureVirtual, environment.getVirtualTemperatureAtLocation(location));
+}
+
+template <class Pseudoadiabat, class Real>
+bool AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::completeTimeStep()
+{
+	//finish thermodynamics of the current timestep and tell whether the phase continues
+	if (phase == Phase::moistAdiabat)
+	{
+		parcel.updateCurrentThermodynamicsAdiabatically(lambda, gamma);
+
+		if (parcel.mixingRatioSaturated[parcel.currentTimeStep] > parcel.mixingRatio[parcel.currentTimeStep])
+		{
+			return true;
+		}
+
+		//equalise mixing ratio and saturation mixing ratio at the end of adiabatic ascent
+		parcel.mixingRatio[parcel.currentTimeStep] = parcel.mixingRatioSaturated[parcel.currentTimeStep];
+		return false;
+	}
+
+	Real pressureDelta = parcel.pressure[parcel.currentTimeStep] - stepStartSlice.pressure;
+	parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepStartSlice, pressureDelta, wetBulbPotentialTemp);
+	parcel.updateCurrentThermodynamicsPseudoadiabatically();
+
+	return parcel.mixingRatio[parcel.currentTimeStep] > parcel.noMoistureTreshold && parcel.velocity[parcel.currentTimeStep] > 0;
+}
+
+template <class Pseudoadiabat, class Real>
+bool AdamsBashforthMoultonDynamics<Pseudoadiabat, Real>::isParcelWithinBounds()
+{
+	if (parcel.position[parcel.currentTimeStep] >= environment.highestPoint)
+	{
+		return false;
+	}
+	else if (parcel.position[parcel.currentTimeStep] <= 0.0)
+	{
+		return false;
+	}
+	else if (parcel.currentTimeStep >= parcel.ascentSteps - 1)
+	{
+		return false;
+	}
+	else
+	{
+		return true;
+	}
+}
+
+template class AdamsBashforthMoultonDynamics<FiniteDifferencePseudoadiabat, float>;
+template class AdamsBashforthMoultonDynamics<RungeKuttaPseudoadiabat, float>;
+template class AdamsBashforthMoultonDynamics<NumericalPseudoadiabat, float>;
+template class AdamsBashforthMoultonDynamics<TablePseudoadiabat, float>;
+
+template class AdamsBashforthMoultonDynamics<FiniteDifferencePseudoadiabat, double>;
+template class AdamsBashforthMoultonDynamics<RungeKuttaPseudoadiabat, double>;
+template class AdamsBashforthMoultonDynamics<NumericalPseudoadiabat, double>;
+template class AdamsBashforthMoultonDynamics<TablePseudoadiabat, double>;
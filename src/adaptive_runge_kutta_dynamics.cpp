@@ -0,0 +1,316 @@
+#include "thermodynamic_calc.h"
+#include "environment.h"
+#include "parcel.h"
+#include "dynamic_scheme.h"
+#include "pseudoadiabatic_scheme.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
+
+template <class Pseudoadiabat, class Real>
+AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::AdaptiveRungeKuttaDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme, double tolerance) :
+	sourceEnvironment(environment),
+	convertedEnvironment(environment),
+	environment(convertedEnvironment.get()),
+	pseudoadiabaticScheme(pseudoadiabaticScheme),
+	tolerance(tolerance),
+	stepSize(0.0),
+	phase(Phase::moistAdiabat),
+	gamma(0.0),
+	lambda(0.0),
+	wetBulbPotentialTemp(0.0)
+{
+}
+
+template <class Pseudoadiabat, class Real>
+Parcel AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::runSimulationOn(Parcel& passedParcel)
+{
+	parcel = convertParcel(passedParcel, environment);
+	stepSize = parcel.timeDelta;
+
+	while (isParcelWithinBounds())
+	{
+		ascentAlongMoistAdiabat();
+		ascentAlongPseudoAdiabat();
+	}
+
+	return convertParcel(parcel, sourceEnvironment);
+}
+
+template <class Pseudoadiabat, class Real>
+void AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::ascentAlongMoistAdiabat()
+{
+	INSTRUMENT_PHASE(moistAdiabat);
+
+	//calculate ascent constants
+	gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
+	lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
+
+	if (!isParcelWithinBounds())
+	{
+		return;
+	}
+
+	//integrate until the parcel becomes saturated on the output grid
+	phase = Phase::moistAdiabat;
+	integratePhase();
+}
+
+template <class Pseudoadiabat, class Real>
+void AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::ascentAlongPseudoAdiabat()
+{
+	INSTRUMENT_PHASE(pseudoAdiabat);
+
+	//calculate wet-bulb potential temperature for pseudoadiabatic ascent
+	wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
+
+	if (parcel.mixingRatio[parcel.currentTimeStep] <= parcel.noMoistureTreshold || parcel.velocity[parcel.currentTimeStep] <= 0)
+	{
+		return;
+	}
+
+	if (!isParcelWithinBounds())
+	{
+		return;
+	}
+
+	//integrate until the point of no moisture or until the parcel starts to descend
+	phase = Phase::pseudoAdiabat;
+	integratePhase();
+}
+
+template <class Pseudoadiabat, class Real>
+void AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::integratePhase()
+{
+	//Dormand & Prince (1980) coefficients, dense output after Hairer, Norsett & Wanner (1993)
+	const Real a21 = 1.0 / 5.0;
+	const Real a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+	const Real a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+	const Real a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+	const Real a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0, a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+	const Real b1 = 35.0 / 384.0, b3 = 500.0 / 1113.0, b4 = 125.0 / 192.0, b5 = -2187.0 / 6784.0, b6 = 11.0 / 84.0;
+	const Real e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0, e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+	const Real d1 = -12715105075.0 / 11282082432.0, d3 = 87487479700.0 / 32700410799.0, d4 = -10690763975.0 / 1880347072.0;
+	const Real d5 = 701980252875.0 / 199316789632.0, d6 = -1453857185.0 / 822651844.0, d7 = 69997945.0 / 29380423.0;
+
+	//step size limits; the upper one stays well below the buoyancy oscillation period
+	const Real minStepSize = Real(0.001) * parcel.timeDelta;
+	const Real maxStepSize = 60.0;
+
+	size_t phaseStartStep = parcel.currentTimeStep;
+	size_t lastStep = parcel.ascentSteps - 1;
+	Real time = 0.0; //time since the start of the phase
+
+	stepStartSlice = parcel.getSlice(0);
+
+	Real z0 = parcel.position[parcel.currentTimeStep];
+	Real w0 = parcel.velocity[parcel.currentTimeStep];
+	Real K1 = calcBouyancyAtPosition(z0);
+
+	while (true)
+	{
+		Real h = std::min(stepSize, maxStepSize);
+
+		//stages of the system dz/dt = w, dw/dt = B(z)
+		Real C1 = w0;
+
+		Real z2 = z0 + h * (a21 * C1);
+		Real C2 = w0 + h * (a21 * K1);
+		Real K2 = calcBouyancyAtPosition(z2);
+
+		Real z3 = z0 + h * (a31 * C1 + a32 * C2);
+		Real C3 = w0 + h * (a31 * K1 + a32 * K2);
+		Real K3 = calcBouyancyAtPosition(z3);
+
+		Real z4 = z0 + h * (a41 * C1 + a42 * C2 + a43 * C3);
+		Real C4 = w0 + h * (a41 * K1 + a42 * K2 + a43 * K3);
+		Real K4 = calcBouyancyAtPosition(z4);
+
+		Real z5 = z0 + h * (a51 * C1 + a52 * C2 + a53 * C3 + a54 * C4);
+		Real C5 = w0 + h * (a51 * K1 + a52 * K2 + a53 * K3 + a54 * K4);
+		Real K5 = calcBouyancyAtPosition(z5);
+
+		Real z6 = z0 + h * (a61 * C1 + a62 * C2 + a63 * C3 + a64 * C4 + a65 * C5);
+		Real C6 = w0 + h * (a61 * K1 + a62 * K2 + a63 * K3 + a64 * K4 + a65 * K5);
+		Real K6 = calcBouyancyAtPosition(z6);
+
+		Real z7 = z0 + h * (b1 * C1 + b3 * C3 + b4 * C4 + b5 * C5 + b6 * C6);
+		Real C7 = w0 + h * (b1 * K1 + b3 * K3 + b4 * K4 + b5 * K5 + b6 * K6);
+		Real K7 = calcBouyancyAtPosition(z7);
+
+		//stages outside of the profile rely on extrapolation, so only allow them for steps up to the output timestep
+		Real lowestStage = std::min({ z2, z3, z4, z5, z6, z7 });
+		Real highestStage = std::max({ z2, z3, z4, z5, z6, z7 });
+
+		if ((lowestStage <= 0.0 || highestStage >= environment.highestPoint) && h > parcel.timeDelta)
+		{
+			stepSize = std::max(Real(0.5) * h, parcel.timeDelta);
+			continue;
+		}
+
+		//difference between 5th and 4th order solutions, scaled by the mixed tolerance
+		Real positionError = h * (e1 * C1 + e3 * C3 + e4 * C4 + e5 * C5 + e6 * C6 + e7 * C7);
+		Real velocityError = h * (e1 * K1 + e3 * K3 + e4 * K4 + e5 * K5 + e6 * K6 + e7 * K7);
+		Real positionScale = tolerance * (Real(1.0) + std::max(std::abs(z0), std::abs(z7)));
+		Real velocityScale = tolerance * (Real(1.0) + std::max(std::abs(w0), std::abs(C7)));
+		Real errorNorm = std::max(std::abs(positionError) / positionScale, std::abs(velocityError) / velocityScale);
+
+		Real stepFactor = std::max(Real(0.2), Real(0.9) * std::pow(errorNorm, Real(-0.2)));
+
+		if (!(errorNorm <= 1.0) && h > minStepSize)
+		{
+			stepSize = std::max(h * std::min(stepFactor, Real(1.0)), minStepSize);
+			continue;
+		}
+
+		//dense output polynomial coefficients
+		Real zDifference = z7 - z0;
+		Real zSpline = (h * C1) - zDifference;
+		Real zCubic = zDifference - (h * C7) - zSpline;
+		Real zQuartic = h * (d1 * C1 + d3 * C3 + d4 * C4 + d5 * C5 + d6 * C6 + d7 * C7);
+
+		Real wDifference = C7 - w0;
+		Real wSpline = (h * K1) - wDifference;
+		Real wCubic = wDifference - (h * K7) - wSpline;
+		Real wQuartic = h * (d1 * K1 + d3 * K3 + d4 * K4 + d5 * K5 + d6 * K6 + d7 * K7);
+
+		//write all output timesteps covered by the accepted step
+		size_t gridStep = parcel.currentTimeStep + 1;
+
+		while (gridStep <= lastStep && ((gridStep - phaseStartStep) * parcel.timeDelta) <= time + h)
+		{
+			Real theta = (((gridStep - phaseStartStep) * parcel.timeDelta) - time) / h;
+			Real theta1 = Real(1.0) - theta;
+
+			parcel.position[gridStep] = z0 + theta * (zDifference + theta1 * (zSpline + theta * (zCubic + theta1 * zQuartic)));
+			parcel.velocity[gridStep] = w0 + theta * (wDifference + theta1 * (wSpline + theta * (wCubic + theta1 * wQuartic)));
+
+			//update parcel properties
+			parcel.currentTimeStep = gridStep;
+			INSTRUMENT_COUNT(timesteps);
+			parcel.updateCurrentDynamicsAndPressure();
+
+			if (!completeGridPoint() || !isParcelWithinBounds())
+			{
+				return;
+			}
+
+			gridStep++;
+		}
+
+		//advance the integrator, last stage is the first stage of the next step
+		time += h;
+		z0 = z7;
+		w0 = C7;
+		K1 = K7;
+
+		if (phase == Phase::pseudoAdiabat)
+		{
+			stepStartSlice = calcSliceAtPosition(z0);
+		}
+
+		stepSize = std::min(h * std::min(stepFactor, Real(5.0)), maxStepSize);
+	}
+}
+
+template <class Pseudoadiabat, class Real>
+Real AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::calcBouyancyAtPosition(Real position)
+{
+	INSTRUMENT_COUNT(stageEvaluations);
+
+	typename BasicEnvironment<Real>::Location location = parcel.currentLocation;
+	location.position = position;
+	location.updateSector(environment);
+
+	Real pressure = environment.getPressureAtLocation(location);
+	Real temperatureVirtual;
+
+	if (phase == Phase::moistAdiabat)
+	{
+		Real temperature = parcel.getTemperatureInAdiabat(pressure, gamma, lambda);
+		temperatureVirtual = calcVirtualTemperature(temperature, stepStartSlice.mixingRatio);
+	}
+	else
+	{
+		Real temperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepStartSlice, pressure - stepStartSlice.pressure, wetBulbPotentialTemp);
+		Real mixingRatio = parcel.getMixingRatio(temperature, pressure);
+		temperatureVirtual = calcVirtualTemperature(temperature, mixingRatio);
+	}
+
+	return calcBouyancyForce(temperatureVirtual, environment.getVirtualTemperatureAtLocation(location));
+}
+
+template <class Pseudoadiabat, class Real>
+typename BasicParcel<Real>::Slice AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::calcSliceAtPosition(Real position)
+{
+	//saturated parcel state between output timesteps, base of the next pseudoadiabatic step
+	typename BasicEnvironment<Real>::Location location = parcel.currentLocation;
+	location.position = position;
+	location.updateSector(environment);
+
+	typename BasicParcel<Real>::Slice slice;
+	slice.position = position;
+	slice.pressure = environment.getPressureAtLocation(location);
+	slice.temperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepStartSlice, slice.pressure - stepStartSlice.pressure, wetBulbPotentialTemp);
+	slice.mixingRatioSaturated = parcel.getMixingRatio(slice.temperature, slice.pressure);
+	slice.mixingRatio = slice.mixingRatioSaturated;
+	slice.temperatureVirtual = calcVirtualTemperature(slice.temperature, slice.mixingRatio);
+
+	return slice;
+}
+
+template <class Pseudoadiabat, class Real>
+bool AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::completeGridPoint()
+{
+	//finish thermodynamics of the current output timestep and tell whether the phase continues
+	if (phase == Phase::moistAdiabat)
+	{
+		parcel.updateCurrentThermodynamicsAdiabatically(lambda, gamma);
+
+		if (parcel.mixingRatioSaturated[parcel.currentTimeStep] > parcel.mixingRatio[parcel.currentTimeStep])
+		{
+			return true;
+		}
+
+		//equalise mixing ratio and saturation mixing ratio at the end of adiabatic ascent
+		parcel.mixingRatio[parcel.currentTimeStep] = parcel.mixingRatioSaturated[parcel.currentTimeStep];
+		return false;
+	}
+
+	Real pressureDelta = parcel.pressure[parcel.currentTimeStep] - stepStartSlice.pressure;
+	parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepStartSlice, pressureDelta, wetBulbPotentialTemp);
+	parcel.updateCurrentThermodynamicsPseudoadiabatically();
+
+	return parcel.mixingRatio[parcel.currentTimeStep] > parcel.noMoistureTreshold && parcel.velocity[parcel.currentTimeStep] > 0;
+}
+
+template <class Pseudoadiabat, class Real>
+bool AdaptiveRungeKuttaDynamics<Pseudoadiabat, Real>::isParcelWithinBounds()
+{
+	if (parcel.position[parcel.currentTimeStep] >= environment.highestPoint)
+	{
+		return false;
+	}
+	else if (parcel.position[parcel.currentTimeStep] <= 0.0)
+	{
+		return false;
+	}
+	else if (parcel.currentTimeStep >= parcel.ascentSteps - 1)
+	{
+		return false;
+	}
+	else
+	{
+		return true;
+	}
+}
+
+template class AdaptiveRungeKuttaDynamics<FiniteDifferencePseudoadiabat, float>;
+template class AdaptiveRungeKuttaDynamics<RungeKuttaPseudoadiabat, float>;
+template class AdaptiveRungeKuttaDynamics<NumericalPseudoadiabat, float>;
+template class AdaptiveRungeKuttaDynamics<TablePseudoadiabat, float>;
+
+template class AdaptiveRungeKuttaDynamics<FiniteDifferencePseudoadiabat, double>;
+template class AdaptiveRungeKuttaDynamics<RungeKuttaPseudoadiabat, double>;
+template class AdaptiveRungeKuttaDynamics<NumericalPseudoadiabat, double>;
+template class AdaptiveRungeKuttaDynamics<TablePseudoadiabat, double>;
@@ -0,0 +1,237 @@
+#include "environment.h"
+#include "parcel.h"
+#include "dynamic_scheme.h"
+#include "output.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include "batch.h"
+#include "profile_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+Batch::Batch(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration) :
+    modelConfiguration(modelConfiguration),
+    parcelConfiguration(parcelConfiguration),
+    threadCount(0)
+{
+    if (modelConfiguration.find("threads") != modelConfiguration.end())
+    {
+        threadCount = std::stoi(modelConfiguration.at("threads"));
+    }
+
+    if (!listProfilesIn(modelConfiguration.at("batch_input")))
+    {
+        std::cout << "Cannot read batch profiles from " << modelConfiguration.at("batch_input") << "\n";
+        profileFileNames.clear();
+    }
+}
+
+bool Batch::listProfilesIn(const std::string& batchInput)
+{
+    //a directory contributes all its .profile files, an archive all its columns, any other file is a manifest with one profile path per line
+    std::error_code error;
+
+    if (std::filesystem::is_directory(batchInput, error))
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(batchInput, error))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".profile")
+            {
+                profileFileNames.push_back(entry.path().string());
+            }
+        }
+
+        std::sort(profileFileNames.begin(), profileFileNames.end());
+
+        return !error && !profileFileNames.empty();
+    }
+
+    if (ProfileArchive::isProfileArchive(batchInput))
+    {
+        try
+        {
+            archive = std::make_shared<const ProfileArchive>(batchInput);
+        }
+        catch (const std::exception& archiveError)
+        {
+            std::cout << archiveError.what() << "\n";
+            return false;
+        }
+
+        for (size_t column = 0; column < archive->size(); column++)
+        {
+            profileFileNames.push_back(archive->getColumnName(column));
+        }
+
+        return !profileFileNames.empty();
+    }
+
+    std::ifstream manifestFile(batchInput);
+    std::filesystem::path manifestDirectory = std::filesystem::path(batchInput).parent_path();
+    std::string line;
+
+    if (!manifestFile.is_open())
+    {
+        return false;
+    }
+
+    std::set<std::string> profileNames;
+
+    while (getline(manifestFile, line))
+    {
+        //blanks around the path and the '\r' of CRLF manifests are not part of it
+        size_t pathStart = line.find_first_not_of(" \t\r");
+        size_t pathEnd = line.find_last_not_of(" \t\r");
+
+        if (pathStart == std::string::npos || line[pathStart] == '#')
+        {
+            continue;
+        }
+
+        //relative paths start at the directory of the manifest
+        std::filesystem::path profilePath = manifestDirectory / line.substr(pathStart, pathEnd - pathStart + 1);
+
+        //outputs are named after the profiles, two of the same name would write one file concurrently
+        if (!profileNames.insert(profilePath.stem().string()).second)
+        {
+            std::cout << "Batch manifest lists more than one profile named " << profilePath.stem().string() << "\n";
+            return false;
+        }
+
+        profileFileNames.push_back(profilePath.string());
+    }
+
+    return !profileFileNames.empty();
+}
+
+std::string Batch::getProfileOutputFileName(const std::string& outputFileName, const std::string& profileName)
+{
+    //profile name with the extension of output_filename, in the directory of output_filename
+    std::filesystem::path outputPath(outputFileName);
+    std::filesystem::path profileOutputPath = outputPath.parent_path() / profileName;
+
+    return profileOutputPath.string() + outputPath.extension().string();
+}
+
+size_t Batch::size() const
+{
+    return profileFileNames.size();
+}
+
+bool Batch::run()
+{
+    if (profileFileNames.empty())
+    {
+        return false;
+    }
+
+    std::atomic<size_t> failedProfiles(0);
+    std::mutex messageMutex;
+    ThreadPool pool(threadCount);
+
+    std::cout << "Starting the batch of " << profileFileNames.size() << " profiles on " << pool.size() << " threads\n";
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    auto reportFailure = [&failedProfiles, &messageMutex](const std::string& profileFileName, const std::string& reason)
+    {
+        std::lock_guard<std::mutex> lock(messageMutex);
+        std::cout << "Skipping " << profileFileName << ": " << reason << "\n";
+        failedProfiles++;
+    };
+
+    for (size_t profileIndex = 0; profileIndex < profileFileNames.size(); profileIndex++)
+    {
+        const std::string& profileFileName = profileFileNames[profileIndex];
+
+        pool.submit([this, &pool, profileIndex, &profileFileName, reportFailure]()
+            {
+                std::shared_ptr<const Environment> environment;
+
+                try
+                {
+                    //archive columns are read from the shared mapping, no file is opened per profile
+                    if (archive != nullptr)
+                    {
+                        environment = std::make_shared<const Environment>(*archive, profileIndex);
+                    }
+                    else
+                    {
+                        environment = std::make_shared<const Environment>(profileFileName);
+                    }
+                }
+                catch (const std::exception& error)
+                {
+                    reportFailure(profileFileName, error.what());
+                    return;
+                }
+
+                //simulation goes to the back of this worker's queue and runs next, idle workers keep loading
+                pool.submit([this, environment, &profileFileName, reportFailure]()
+                    {
+                        try
+                        {
+                            std::map<std::string, std::string> profileConfiguration = parcelConfiguration;
+                            std::string profileName = archive != nullptr ? profileFileName : std::filesystem::path(profileFileName).stem().string();
+                            profileConfiguration["output_filename"] = getProfileOutputFileName(parcelConfiguration.at("output_filename"), profileName);
+
+                            //counts of the profile start with its setup
+                            INSTRUMENT_RESET();
+                            std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(modelConfiguration, profileConfiguration, *environment);
+
+                            if (dynamicScheme == nullptr)
+                            {
+                                reportFailure(profileFileName, "incorect value of dynamic_scheme, pseudoadiabatic_scheme or floating_point");
+                                return;
+                            }
+
+                            Parcel parcel(*environment, profileConfiguration);
+                            parcel = dynamicScheme->runSimulationOn(parcel);
+
+                            if (!outputDataFrom(parcel))
+                            {
+                                reportFailure(profileFileName, "cannot write " + parcel.outputFileName);
+                            }
+
+                            INSTRUMENT_REPORT(parcel.outputFileName);
+                        }
+                        catch (const std::exception& error)
+                        {
+                            reportFailure(profileFileName, error.what());
+                        }
+                    });
+            });
+    }
+
+    pool.waitForAll();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Batch finished\n";
+
+    double duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+    double throughput = profileFileNames.size() / (duration / 1000.0);
+
+    std::cout << std::fixed << std::setprecision(3) << "Elapsed batch time: " << duration << " ms\n";
+    std::cout << std::setprecision(1) << "Throughput: " << throughput << " profiles/s\n";
+
+    if (failedProfiles > 0)
+    {
+        std::cout << failedProfiles << " of " << profileFileNames.size() << " profiles failed\n";
+        return false;
+    }
+
+    std::cout << "Model output in ./" << std::filesystem::path(parcelConfiguration.at("output_filename")).parent_path().string() << "\n";
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "profile_reader.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//runs the parcel from parcel.conf against every profile of a directory, manifest or packed profile archive, one output per profile
+//every profile is loaded by one pool task, which then queues its own simulation, so loading and simulating overlap
+class Batch
+{
+private:
+	std::map<std::string, std::string> modelConfiguration, parcelConfiguration;
+	std::vector<std::string> profileFileNames; //column names when the input is an archive
+	std::shared_ptr<const ProfileArchive> archive;
+	size_t threadCount;
+
+	bool listProfilesIn(const std::string& batchInput);
+	static std::string getProfileOutputFileName(const std::string& outputFileName, const std::string& profileName);
+
+public:
+	Batch(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+
+	size_t size() const;
+	bool run();
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "configuration.h"
+#include "ensemble.h"
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    //runs of one sweep, for every swept key and for all keys together
+    const size_t maxSweepRuns = 10000;
+
+    bool parseNumber(const std::string& text, double& value)
+    {
+        const char* begin = text.data();
+        const char* end = text.data() + text.size();
+
+        if (begin != end && *begin == '+')
+        {
+            begin++;
+        }
+
+        std::from_chars_result result = std::from_chars(begin, end, value);
+
+        return result.ec == std::errc() && result.ptr == end && begin != end;
+    }
+
+    //12 significant digits hide the rounding of start + i * step, e.g. 25.3 instead of 25.299999999999997
+    std::string formatRangeValue(double value)
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 12);
+
+        return std::string(buffer, result.ptr);
+    }
+
+    std::vector<std::string> splitOn(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream textStream(text);
+        std::string part;
+
+        while (getline(textStream, part, separator))
+        {
+            parts.push_back(part);
+        }
+
+        if (!text.empty() && text.back() == separator)
+        {
+            parts.push_back("");
+        }
+
+        return parts;
+    }
+
+    void addDimensionsOf(const std::map<std::string, std::string>& configuration, bool isModelKey, std::vector<SweepDimension>& dimensions)
+    {
+        for (const auto& [key, value] : configuration)
+        {
+            std::vector<std::string> values;
+
+            try
+            {
+                values = expandSweepValue(value);
+            }
+            catch (const std::runtime_error& error)
+            {
+                throw std::runtime_error(key + "=" + value + ": " + error.what());
+            }
+
+            if (values.size() > 1)
+            {
+                dimensions.push_back({ key, values, isModelKey });
+            }
+        }
+    }
+}
+
+std::map<std::string, std::string> readConfigurationFromFile(std::string filename)
+{
+    std::map<std::string, std::string> config;
+    std::ifstream configFile("config/" + filename);
+    std::string line;
+
+    std::cout << "Reading configuration file " << filename << "\n";
+
+    //read file into a map
+    while (getline(configFile, line))
+    {
+        if (line[0] != '#' && line[0] != '\n' && line[0] != '\0') //read only lines containing variables
+        {
+            std::stringstream lineStream(line);
+            std::string key, value;
+
+            getline(lineStream, key, '=');
+            getline(lineStream, value, '=');
+
+            config.insert({ key, value });
+        }
+    }
+
+    if(config.find("profile_filename") != config.end())
+    {
+        config["profile_filename"] = "input/" + config["profile_filename"];
+    }
+        
+
+    if (config.find("output_filename") != config.end())
+    {
+        config["output_filename"] = "output/" + config["output_filename"];
+    }
+
+    if (config.find("batch_input") != config.end())
+    {
+        config["batch_input"] = "input/" + config["batch_input"];
+    }
+
+    if (config.find("ensemble_filename") != config.end())
+    {
+        config["ensemble_filename"] = "config/" + config["ensemble_filename"];
+    }
+       
+    configFile.close();
+
+    return config;
+}
+
+std::vector<std::string> expandSweepValue(const std::string& value)
+{
+    //only numeric values are expanded, so file names with ':' or ',' stay untouched
+    std::vector<std::string> rangeParts = splitOn(value, ':');
+    double start, end, step;
+
+    if (rangeParts.size() == 3 && parseNumber(rangeParts[0], start) && parseNumber(rangeParts[1], end) && parseNumber(rangeParts[2], step))
+    {
+        if (!std::isfinite(start) || !std::isfinite(end) || !(step > 0.0) || !(end >= start))
+        {
+            throw std::runtime_error("a range needs end >= start and a positive step");
+        }
+
+        //tolerance keeps the end point despite rounding of the step
+        double steps = std::floor(((end - start) / step) + 1e-9);
+
+        if (!(steps < maxSweepRuns))
+        {
+            throw std::runtime_error("the range has more than " + std::to_string(maxSweepRuns) + " values");
+        }
+
+        size_t count = static_cast<size_t>(steps) + 1;
+        std::vector<std::string> values;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            values.push_back(formatRangeValue(start + (i * step)));
+        }
+
+        return values;
+    }
+
+    std::vector<std::string> listParts = splitOn(value, ',');
+
+    if (listParts.size() > 1)
+    {
+        for (const std::string& part : listParts)
+        {
+            double number;
+
+            if (!parseNumber(part, number))
+            {
+                return { value };
+            }
+        }
+
+        if (listParts.size() > maxSweepRuns)
+        {
+            throw std::runtime_error("the list has more than " + std::to_string(maxSweepRuns) + " values");
+        }
+
+        return listParts;
+    }
+
+    return { value };
+}
+
+ParameterSweep expandParameterSweep(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration)
+{
+    ParameterSweep sweep;
+
+    addDimensionsOf(modelConfiguration, true, sweep.dimensions);
+    addDimensionsOf(parcelConfiguration, false, sweep.dimensions);
+
+    size_t runCount = 1;
+
+    for (const SweepDimension& dimension : sweep.dimensions)
+    {
+        if (runCount > maxSweepRuns / dimension.values.size())
+        {
+            throw std::runtime_error("the swept keys together give more than " + std::to_string(maxSweepRuns) + " runs");
+        }
+
+        runCount *= dimension.values.size();
+    }
+
+    //last dimension varies fastest
+    for (size_t run = 0; run < runCount; run++)
+    {
+        std::map<std::string, std::string> runModelConfiguration = modelConfiguration;
+        std::map<std::string, std::string> runParcelConfiguration = parcelConfiguration;
+        size_t remainder = run;
+
+        for (size_t j = sweep.dimensions.size(); j-- > 0;)
+        {
+            const SweepDimension& dimension = sweep.dimensions[j];
+            const std::string& value = dimension.values[remainder % dimension.values.size()];
+            remainder /= dimension.values.size();
+
+            (dimension.isModelKey ? runModelConfiguration : runParcelConfiguration)[dimension.key] = value;
+        }
+
+        if (!sweep.dimensions.empty())
+        {
+            runParcelConfiguration["output_filename"] = Ensemble::getMemberOutputFileName(parcelConfiguration.at("output_filename"), run);
+        }
+
+        sweep.modelConfigurations.push_back(runModelConfiguration);
+        sweep.parcelConfigurations.push_back(runParcelConfiguration);
+    }
+
+    return sweep;
+}
+
+bool writeSweepIndex(const std::string& fileName, const ParameterSweep& sweep)
+{
+    //semicolon-separated like the profiles: run number, output file and the swept values
+    std::ofstream indexFile(fileName);
+
+    if (!indexFile.is_open())
+    {
+        return false;
+    }
+
+    indexFile << "run; output_filename; ";
+
+    for (const SweepDimension& dimension : sweep.dimensions)
+    {
+        indexFile << dimension.key << "; ";
+    }
+
+    indexFile << "\n";
+
+    for (size_t run = 0; run < sweep.size(); run++)
+    {
+        indexFile << run << "; " << sweep.parcelConfigurations[run].at("output_filename") << "; ";
+
+        for (const SweepDimension& dimension : sweep.dimensions)
+        {
+            const std::map<std::string, std::string>& configuration = dimension.isModelKey ? sweep.modelConfigurations[run] : sweep.parcelConfigurations[run];
+            indexFile << configuration.at(dimension.key) << "; ";
+        }
+
+        indexFile << "\n";
+    }
+
+    return indexFile.good();
+}
@@ -0,0 +1,39 @@
+#ifndef CONFIGURATION_H
+#define CONFIGURATION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+//key=value pairs of a file in the config directory, with input and output paths resolved
+std::map<std::string, std::string> readConfigurationFromFile(std::string filename);
+
+//parameter sweep: a numeric value may be a range start:end:step (end included) or a list a,b,c
+//all swept keys of model.conf and parcel.conf together form a Cartesian product of runs
+struct SweepDimension
+{
+	std::string key;
+	std::vector<std::string> values;
+	bool isModelKey;
+};
+
+struct ParameterSweep
+{
+	std::vector<SweepDimension> dimensions;
+	std::vector<std::map<std::string, std::string>> modelConfigurations, parcelConfigurations;
+
+	size_t size() const { return parcelConfigurations.size(); }
+};
+
+//values of one key, a single value when it is not a range or a numeric list
+//throws std::runtime_error for a numeric range that is empty or runs backwards, and for more than 10000 values
+std::vector<std::string> expandSweepValue(const std::string& value);
+
+//every combination gets the output file name of the ensemble members, e.g. name_0007.output
+//throws std::runtime_error naming the key of an invalid value, or when the combinations exceed 10000 runs
+ParameterSweep expandParameterSweep(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+
+//table of the swept values of every run, so the numbered outputs can be told apart
+bool writeSweepIndex(const std::string& fileName, const ParameterSweep& sweep);
+
+#endif
@@ -0,0 +1,280 @@
+#include "environment.h"
+#include "parcel.h"
+#include "parcel_summary.h"
+#include "dynamic_scheme.h"
+#include "thread_pool.h"
+#include "convergence.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::vector<std::string> splitOnSpaces(const std::string& value)
+    {
+        std::stringstream valueStream(value);
+        std::vector<std::string> parts;
+        std::string part;
+
+        while (valueStream >> part)
+        {
+            parts.push_back(part);
+        }
+
+        return parts;
+    }
+
+    std::string formatValue(double value)
+    {
+        std::stringstream valueStream;
+        valueStream << std::fixed << std::setprecision(5) << value;
+
+        return valueStream.str();
+    }
+}
+
+ConvergenceStudy::ConvergenceStudy(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration) :
+    environment(environment),
+    modelConfiguration(modelConfiguration),
+    parcelConfiguration(parcelConfiguration),
+    dynamicSchemes(splitOnSpaces(modelConfiguration.at("convergence_dynamic_schemes"))),
+    pseudoadiabaticSchemes(splitOnSpaces(modelConfiguration.at("convergence_pseudoadiabatic_schemes"))),
+    coarsestTimestep(std::stod(modelConfiguration.at("convergence_timestep"))),
+    heightTolerance(std::stod(modelConfiguration.at("convergence_height_tolerance"))),
+    velocityTolerance(std::stod(modelConfiguration.at("convergence_velocity_tolerance"))),
+    levels(std::stoi(modelConfiguration.at("convergence_levels"))),
+    threadCount(0)
+{
+    if (modelConfiguration.find("threads") != modelConfiguration.end())
+    {
+        threadCount = std::stoi(modelConfiguration.at("threads"));
+    }
+
+    //nothing is queued for an invalid study, run() reports it
+    if (!isValid())
+    {
+        return;
+    }
+
+    //runs of one pair are consecutive, from the coarsest timestep
+    for (const std::string& dynamicScheme : dynamicSchemes)
+    {
+        for (const std::string& pseudoadiabaticScheme : pseudoadiabaticSchemes)
+        {
+            for (int level = 0; level < levels; level++)
+            {
+                runs.push_back({ dynamicScheme, pseudoadiabaticScheme, coarsestTimestep / std::pow(2.0, level), 0.0, 0.0, 0.0, 0.0, false });
+            }
+        }
+    }
+}
+
+bool ConvergenceStudy::isValid() const
+{
+    //the finest timestep of the largest study is the coarsest one divided by 2^(maxLevels - 1)
+    const int maxLevels = 20;
+
+    return levels >= 3 && levels <= maxLevels && coarsestTimestep > 0.0 && !dynamicSchemes.empty() && !pseudoadiabaticSchemes.empty();
+}
+
+ConvergenceStudy::Extrapolation ConvergenceStudy::extrapolate(const std::vector<double>& values)
+{
+    //order from the three finest timesteps: (f1 - f2) / (f2 - f3) = 2^p for timesteps halved between them
+    Extrapolation extrapolation;
+    size_t finest = values.size() - 1;
+    double coarseDifference = values[finest - 2] - values[finest - 1];
+    double fineDifference = values[finest - 1] - values[finest];
+
+    extrapolation.order = std::numeric_limits<double>::quiet_NaN();
+    extrapolation.value = values[finest];
+
+    if (coarseDifference * fineDifference > 0.0)
+    {
+        double order = std::log2(coarseDifference / fineDifference);
+
+        if (order > 0.0)
+        {
+            extrapolation.order = order;
+            extrapolation.value = values[finest] - (fineDifference / (std::pow(2.0, order) - 1.0));
+        }
+    }
+
+    //without an order the finest run is the reference and its own error is taken as the last difference
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        bool isReference = std::isnan(extrapolation.order) && i == finest;
+        extrapolation.errors.push_back(isReference ? std::abs(fineDifference) : std::abs(values[i] - extrapolation.value));
+    }
+
+    return extrapolation;
+}
+
+bool ConvergenceStudy::run()
+{
+    if (!isValid())
+    {
+        std::cout << "Convergence study needs 3 to 20 convergence_levels, a positive convergence_timestep and some schemes to compare\n";
+        return false;
+    }
+
+    std::atomic<size_t> failedRuns(0);
+    ThreadPool pool(threadCount);
+
+    std::cout << "Starting the convergence study of " << runs.size() << " runs on " << pool.size() << " threads\n";
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        pool.submit([this, i, &failedRuns]()
+            {
+                try
+                {
+                    //only the diagnostics are needed, so the trajectory is not kept
+                    std::map<std::string, std::string> runModelConfiguration = modelConfiguration;
+                    std::map<std::string, std::string> runConfiguration = parcelConfiguration;
+                    runModelConfiguration["dynamic_scheme"] = runs[i].dynamicScheme;
+                    runConfiguration["pseudoadiabatic_scheme"] = runs[i].pseudoadiabaticScheme;
+                    std::stringstream timestepStream;
+                    timestepStream << std::setprecision(17) << runs[i].timestep;
+                    runConfiguration["timestep"] = timestepStream.str();
+                    runConfiguration["output_mode"] = "summary";
+
+                    std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(runModelConfiguration, runConfiguration, environment);
+
+                    if (dynamicScheme == nullptr)
+                    {
+                        failedRuns++;
+                        return;
+                    }
+
+                    Parcel parcel(environment, runConfiguration);
+                    parcel = dynamicScheme->runSimulationOn(parcel);
+
+                    ParcelSummary summary = parcel.getSummary();
+                    runs[i].cloudTopHeight = summary.cloudTopHeight;
+                    runs[i].maxVelocity = summary.maxVelocity;
+                    runs[i].isFinished = true;
+                }
+                catch (const std::exception&)
+                {
+                    failedRuns++;
+                }
+            });
+    }
+
+    pool.waitForAll();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Convergence study finished\n";
+
+    double duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+    std::cout << std::fixed << std::setprecision(3) << "Elapsed convergence study time: " << duration << " ms\n";
+
+    if (failedRuns > 0)
+    {
+        std::cout << failedRuns << " of " << runs.size() << " runs failed, check convergence_dynamic_schemes and convergence_pseudoadiabatic_schemes\n";
+        return false;
+    }
+
+    //every pair: errors of its timesteps and the largest timestep within both tolerances (with all finer ones)
+    std::vector<std::string> pairRows;
+    std::cout << "dynamic/pseudoadiabatic scheme: observed order of cloud top and max velocity, recommended timestep\n";
+    size_t levelCount = levels;
+
+    for (size_t pairStart = 0; pairStart < runs.size(); pairStart += levelCount)
+    {
+        std::vector<double> cloudTopHeights, maxVelocities;
+
+        for (size_t level = 0; level < levelCount; level++)
+        {
+            cloudTopHeights.push_back(runs[pairStart + level].cloudTopHeight);
+            maxVelocities.push_back(runs[pairStart + level].maxVelocity);
+        }
+
+        Extrapolation cloudTop = extrapolate(cloudTopHeights);
+        Extrapolation maxVelocity = extrapolate(maxVelocities);
+        double recommendedTimestep = std::numeric_limits<double>::quiet_NaN();
+
+        for (size_t level = levelCount; level-- > 0;)
+        {
+            if (!(cloudTop.errors[level] <= heightTolerance && maxVelocity.errors[level] <= velocityTolerance))
+            {
+                break;
+            }
+
+            recommendedTimestep = runs[pairStart + level].timestep;
+        }
+
+        for (size_t level = 0; level < levelCount; level++)
+        {
+            runs[pairStart + level].cloudTopError = cloudTop.errors[level];
+            runs[pairStart + level].maxVelocityError = maxVelocity.errors[level];
+        }
+
+        const Run& pair = runs[pairStart];
+        pairRows.push_back(pair.dynamicScheme + "; " + pair.pseudoadiabaticScheme + "; " + formatValue(cloudTop.order) + "; " + formatValue(maxVelocity.order) + "; "
+            + formatValue(cloudTop.value) + "; " + formatValue(maxVelocity.value) + "; " + formatValue(recommendedTimestep) + ";");
+
+        std::cout << std::setprecision(2) << "  " << pair.dynamicScheme << "/" << pair.pseudoadiabaticScheme << ": order " << cloudTop.order << " and " << maxVelocity.order << ", ";
+
+        if (std::isnan(recommendedTimestep))
+        {
+            std::cout << "no tested timestep meets the tolerance\n";
+        }
+        else
+        {
+            std::cout << "timestep " << std::setprecision(5) << recommendedTimestep << " s\n";
+        }
+    }
+
+    std::string reportFileName = std::filesystem::path(parcelConfiguration.at("output_filename")).replace_extension(".convergence").string();
+
+    if (!writeReport(reportFileName, pairRows))
+    {
+        std::cout << "Directory ./output must exits. Please create it!\n";
+        return false;
+    }
+
+    std::cout << "Convergence report in ./" << reportFileName << "\n";
+
+    return true;
+}
+
+bool ConvergenceStudy::writeReport(const std::string& fileName, const std::vector<std::string>& pairRows) const
+{
+    //every run, then one row per scheme pair; errors are estimated against the extrapolated values
+    std::ofstream report(fileName);
+
+    if (!report.is_open())
+    {
+        return false;
+    }
+
+    report << "dynamic_scheme; pseudoadiabatic_scheme; timestep; cloud_top_height; max_velocity; cloud_top_error; max_velocity_error;\n";
+
+    for (const Run& run : runs)
+    {
+        report << run.dynamicScheme << "; " << run.pseudoadiabaticScheme << "; " << formatValue(run.timestep) << "; " << formatValue(run.cloudTopHeight) << "; "
+            << formatValue(run.maxVelocity) << "; " << formatValue(run.cloudTopError) << "; " << formatValue(run.maxVelocityError) << ";\n";
+    }
+
+    report << "\ndynamic_scheme; pseudoadiabatic_scheme; cloud_top_order; max_velocity_order; cloud_top_extrapolated; max_velocity_extrapolated; recommended_timestep;\n";
+
+    for (const std::string& row : pairRows)
+    {
+        report << row << "\n";
+    }
+
+    return report.good();
+}
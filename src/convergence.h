@@ -0,0 +1,49 @@
+#ifndef CONVERGENCE_H
+#define CONVERGENCE_H
+
+#include "environment.h"
+#include <map>
+#include <string>
+#include <vector>
+
+//timestep convergence study (run_mode=convergence): the parcel from parcel.conf runs at successively halved timesteps
+//for every listed pair of dynamic and pseudoadiabatic scheme, Richardson extrapolation of cloud top height and
+//maximum velocity estimates the observed order and the error of every timestep
+class ConvergenceStudy
+{
+private:
+	struct Run
+	{
+		std::string dynamicScheme, pseudoadiabaticScheme;
+		double timestep;
+		double cloudTopHeight, maxVelocity;
+		double cloudTopError, maxVelocityError;
+		bool isFinished;
+	};
+
+	//extrapolation of one quantity over the timesteps of a scheme pair, NaN order when the runs are not in the asymptotic range
+	struct Extrapolation
+	{
+		double order, value;
+		std::vector<double> errors;
+	};
+
+	const Environment& environment;
+	std::map<std::string, std::string> modelConfiguration, parcelConfiguration;
+	std::vector<std::string> dynamicSchemes, pseudoadiabaticSchemes;
+	double coarsestTimestep, heightTolerance, velocityTolerance;
+	int levels; //signed, so a negative convergence_levels is rejected instead of wrapping around
+	size_t threadCount;
+	std::vector<Run> runs;
+
+	bool isValid() const;
+	static Extrapolation extrapolate(const std::vector<double>& values);
+	bool writeReport(const std::string& fileName, const std::vector<std::string>& pairRows) const;
+
+public:
+	ConvergenceStudy(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+
+	bool run();
+};
+
+#endif
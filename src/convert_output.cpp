@@ -0,0 +1,41 @@
+#include "trajectory_field.h"
+#include "output.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//converts binary model output (output_format=binary) back to the semicolon-separated text format
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: " << argv[0] << " <binary output file> <text output file>\n";
+        return -1;
+    }
+
+    std::vector<std::string> names;
+    std::vector<TrajectoryField> columns;
+    size_t rows;
+
+    if (!readBinaryOutput(argv[1], names, columns, rows))
+    {
+        return -1;
+    }
+
+    OutputTable table;
+    table.rows = rows;
+
+    for (size_t j = 0; j < columns.size(); j++)
+    {
+        table.columns.push_back({ names[j], &columns[j] });
+    }
+
+    if (!writeTextOutput(argv[2], table))
+    {
+        return -1;
+    }
+
+    std::cout << "Converted " << rows << " rows into " << argv[2] << "\n";
+    return 0;
+}
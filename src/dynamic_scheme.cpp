@@ -0,0 +1,94 @@
+#include "dynamic_scheme.h"
+#include "pseudoadiabatic_scheme.h"
+#include "pseudoadiabat_table.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace
+{
+	//instantiates the dynamics for the pseudoadiabatic scheme given in parcel.conf, extra arguments go to the dynamics constructor
+	template <template <class, class> class Dynamics, class Real, class... Arguments>
+	std::unique_ptr<DynamicScheme> createWithPseudoadiabat(const std::map<std::string, std::string>& parcelConfiguration, const Environment& environment, Arguments... arguments)
+	{
+		size_t pseudoadiabaticSchemeID = std::stoi(parcelConfiguration.at("pseudoadiabatic_scheme"));
+
+		if (pseudoadiabaticSchemeID == 1)
+		{
+			return std::make_unique<Dynamics<FiniteDifferencePseudoadiabat, Real>>(environment, FiniteDifferencePseudoadiabat(), arguments...);
+		}
+		else if (pseudoadiabaticSchemeID == 2)
+		{
+			return std::make_unique<Dynamics<RungeKuttaPseudoadiabat, Real>>(environment, RungeKuttaPseudoadiabat(), arguments...);
+		}
+		else if (pseudoadiabaticSchemeID == 3)
+		{
+			return std::make_unique<Dynamics<NumericalPseudoadiabat, Real>>(environment, NumericalPseudoadiabat(), arguments...);
+		}
+		else if (pseudoadiabaticSchemeID == 4)
+		{
+			auto cacheFileName = parcelConfiguration.find("pseudoadiabat_table_cache");
+			const PseudoadiabatTable& table = PseudoadiabatTable::getInstance(cacheFileName != parcelConfiguration.end() ? cacheFileName->second : "");
+
+			return std::make_unique<Dynamics<TablePseudoadiabat, Real>>(environment, TablePseudoadiabat(table), arguments...);
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	//instantiates the dynamics given in model.conf in the floating-point type Real
+	template <class Real>
+	std::unique_ptr<DynamicScheme> createInPrecision(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration, const Environment& environment)
+	{
+		size_t dynamicSchemeID = std::stoi(modelConfiguration.at("dynamic_scheme"));
+
+		if (dynamicSchemeID == 1)
+		{
+			return createWithPseudoadiabat<FiniteDifferenceDynamics, Real>(parcelConfiguration, environment);
+		}
+		else if (dynamicSchemeID == 2)
+		{
+			return createWithPseudoadiabat<RungeKuttaDynamics, Real>(parcelConfiguration, environment);
+		}
+		else if (dynamicSchemeID == 3)
+		{
+			double tolerance = 1e-6;
+
+			if (modelConfiguration.find("adaptive_tolerance") != modelConfiguration.end())
+			{
+				tolerance = std::stod(modelConfiguration.at("adaptive_tolerance"));
+			}
+
+			return createWithPseudoadiabat<AdaptiveRungeKuttaDynamics, Real>(parcelConfiguration, environment, tolerance);
+		}
+		else if (dynamicSchemeID == 4)
+		{
+			return createWithPseudoadiabat<AdamsBashforthMoultonDynamics, Real>(parcelConfiguration, environment);
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+}
+
+std::unique_ptr<DynamicScheme> createDynamicScheme(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration, const Environment& environment)
+{
+	//double unless parcel.conf asks for floating_point=float
+	auto floatingPoint = parcelConfiguration.find("floating_point");
+
+	if (floatingPoint == parcelConfiguration.end() || floatingPoint->second == "double")
+	{
+		return createInPrecision<double>(modelConfiguration, parcelConfiguration, environment);
+	}
+	else if (floatingPoint->second == "float")
+	{
+		return createInPrecision<float>(modelConfiguration, parcelConfiguration, environment);
+	}
+	else
+	{
+		return nullptr;
+	}
+}
@@ -5,7 +5,10 @@
 #include "environment.h"
 #include "parcel.h"
 #include "pseudoadiabatic_scheme.h"
+#include <map>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 class DynamicScheme
 {
@@ -16,12 +19,56 @@ public:
 	virtual ~DynamicScheme() = default;
 };
 
-class FiniteDifferenceDynamics : public DynamicScheme
+//profile in the floating-point type of the dynamics, converted once per scheme
+template <class Real>
+class ConvertedEnvironment
 {
+public:
+	ConvertedEnvironment(const Environment& environment) : environment(environment) {};
+	const BasicEnvironment<Real>& get() const { return environment; };
+
 private:
-	Parcel parcel;
+	BasicEnvironment<Real> environment;
+};
 
-	std::unique_ptr<PseudoAdiabaticScheme> choosePseudoAdiabaticScheme();
+//double dynamics use the passed profile as it is
+template <>
+class ConvertedEnvironment<double>
+{
+public:
+	ConvertedEnvironment(const Environment& environment) : environment(environment) {};
+	const Environment& get() const { return environment; };
+
+private:
+	const Environment& environment;
+};
+
+//parcels cross the DynamicScheme interface in double, dynamics in float convert them on the way in and out
+template <class Target, class Source>
+BasicParcel<Target> convertParcel(const BasicParcel<Source>& parcel, const BasicEnvironment<Target>& environment)
+{
+	if constexpr (std::is_same<Target, Source>::value)
+	{
+		return parcel;
+	}
+	else
+	{
+		return BasicParcel<Target>(parcel, environment);
+	}
+}
+
+//dynamics are templates over the pseudoadiabatic scheme, so the scheme is called directly in the stepping loop,
+//and over the floating-point type of the parcel (floating_point in parcel.conf)
+//instantiated for every scheme in pseudoadiabatic_scheme.h and for float and double, see createDynamicScheme
+template <class Pseudoadiabat, class Real>
+class FiniteDifferenceDynamics : public DynamicScheme
+{
+private:
+	const Environment& sourceEnvironment;
+	const ConvertedEnvironment<Real> convertedEnvironment;
+	const BasicEnvironment<Real>& environment;
+	Pseudoadiabat pseudoadiabaticScheme;
+	BasicParcel<Real> parcel;
 
 	void ascentAlongMoistAdiabat();
 	void ascentAlongPseudoAdiabat();
@@ -33,26 +80,120 @@ private:
 	bool isParcelWithinBounds();
 
 public:
+	FiniteDifferenceDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme);
 	Parcel runSimulationOn(Parcel& passedParcel);
 };
 
+template <class Pseudoadiabat, class Real>
 class RungeKuttaDynamics : public DynamicScheme
 {
 private:
-	Parcel parcel;
+	const Environment& sourceEnvironment;
+	const ConvertedEnvironment<Real> convertedEnvironment;
+	const BasicEnvironment<Real>& environment;
+	Pseudoadiabat pseudoadiabaticScheme;
+	BasicParcel<Real> parcel;
+
+	void ascentAlongMoistAdiabat();
+	void ascentAlongPseudoAdiabat();
 
-	std::unique_ptr<PseudoAdiabaticScheme> choosePseudoAdiabaticScheme();
+	void makeAdiabaticTimeStep(Real lambda, Real gamma);
+	void makePseudoAdiabaticTimeStep(Real wetBulbTemperature);
+
+	bool isParcelWithinBounds();
+
+public:
+	RungeKuttaDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme);
+	Parcel runSimulationOn(Parcel& passedParcel);
+};
+
+//embedded Dormand-Prince 5(4) pair with step size control and dense output on the regular timestep grid
+template <class Pseudoadiabat, class Real>
+class AdaptiveRungeKuttaDynamics : public DynamicScheme
+{
+private:
+	enum class Phase
+	{
+		moistAdiabat,
+		pseudoAdiabat
+	};
+
+	const Environment& sourceEnvironment;
+	const ConvertedEnvironment<Real> convertedEnvironment;
+	const BasicEnvironment<Real>& environment;
+	Pseudoadiabat pseudoadiabaticScheme;
+	BasicParcel<Real> parcel;
+
+	Real tolerance, stepSize;
+
+	//state of the current ascent phase used by buoyancy evaluations
+	Phase phase;
+	Real gamma, lambda, wetBulbPotentialTemp;
+	typename BasicParcel<Real>::Slice stepStartSlice;
 
 	void ascentAlongMoistAdiabat();
 	void ascentAlongPseudoAdiabat();
 
-	void makeAdiabaticTimeStep(double lambda, double gamma);
-	void makePseudoAdiabaticTimeStep(double wetBulbTemperature);
+	void integratePhase();
+	Real calcBouyancyAtPosition(Real position);
+	typename BasicParcel<Real>::Slice calcSliceAtPosition(Real position);
+	bool completeGridPoint();
 
 	bool isParcelWithinBounds();
 
 public:
+	AdaptiveRungeKuttaDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme, double tolerance);
 	Parcel runSimulationOn(Parcel& passedParcel);
 };
 
+//4th order Adams-Bashforth-Moulton predictor-corrector, two buoyancy evaluations per step
+//started with Runge-Kutta steps and restarted at the beginning of every ascent phase
+template <class Pseudoadiabat, class Real>
+class AdamsBashforthMoultonDynamics : public DynamicScheme
+{
+private:
+	enum class Phase
+	{
+		moistAdiabat,
+		pseudoAdiabat
+	};
+
+	//timesteps of history used by the predictor
+	static const size_t historySteps = 4;
+
+	const Environment& sourceEnvironment;
+	const ConvertedEnvironment<Real> convertedEnvironment;
+	const BasicEnvironment<Real>& environment;
+	Pseudoadiabat pseudoadiabaticScheme;
+	BasicParcel<Real> parcel;
+
+	//state of the current ascent phase used by buoyancy evaluations
+	Phase phase;
+	Real gamma, lambda, wetBulbPotentialTemp;
+	typename BasicParcel<Real>::Slice stepStartSlice;
+
+	//velocity and buoyancy of the last timesteps of the phase, newest first
+	Real velocityHistory[historySteps], bouyancyHistory[historySteps];
+	size_t historySize;
+
+	void ascentAlongMoistAdiabat();
+	void ascentAlongPseudoAdiabat();
+
+	void integratePhase();
+	void makeRungeKuttaTimeStep();
+	void makeMultistepTimeStep();
+	void pushHistory();
+	Real calcBouyancyAtPosition(Real position);
+	bool completeTimeStep();
+
+	bool isParcelWithinBounds();
+
+public:
+	AdamsBashforthMoultonDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme);
+	Parcel runSimulationOn(Parcel& passedParcel);
+};
+
+//picks the dynamics, the pseudoadiabatic scheme and the floating-point type once, nullptr when any of them is unknown
+std::unique_ptr<DynamicScheme> createDynamicScheme(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration, const Environment& environment);
+
 #endif
@@ -0,0 +1,216 @@
+#include "environment.h"
+#include "parcel.h"
+#include "dynamic_scheme.h"
+#include "output.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include "ensemble.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+Ensemble::Ensemble(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration) :
+    environment(environment),
+    modelConfiguration(modelConfiguration),
+    parcelConfiguration(parcelConfiguration),
+    threadCount(0)
+{
+    if (modelConfiguration.find("threads") != modelConfiguration.end())
+    {
+        threadCount = std::stoi(modelConfiguration.at("threads"));
+    }
+
+    std::ifstream membersFile(modelConfiguration.at("ensemble_filename"));
+
+    if (!membersFile.is_open() || !importMembersFrom(membersFile))
+    {
+        std::cout << "Cannot read ensemble members from " << modelConfiguration.at("ensemble_filename") << "\n";
+        memberConfigurations.clear();
+    }
+
+    membersFile.close();
+
+    memberModelConfigurations.assign(memberConfigurations.size(), modelConfiguration);
+}
+
+Ensemble::Ensemble(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::vector<std::map<std::string, std::string>>& memberModelConfigurations, const std::vector<std::map<std::string, std::string>>& memberConfigurations) :
+    environment(environment),
+    modelConfiguration(modelConfiguration),
+    memberModelConfigurations(memberModelConfigurations),
+    memberConfigurations(memberConfigurations),
+    threadCount(0)
+{
+    if (modelConfiguration.find("threads") != modelConfiguration.end())
+    {
+        threadCount = std::stoi(modelConfiguration.at("threads"));
+    }
+}
+
+bool Ensemble::importMembersFrom(std::ifstream& file)
+{
+    //first line names the parcel.conf keys overridden by every member, each next line holds one member
+    std::string line, var;
+    std::vector<std::string> keys;
+
+    while (getline(file, line) && (line[0] == '#' || line[0] == '\0'))
+    {
+        //skip comments before the header
+    }
+
+    std::stringstream headerStream(line);
+
+    while (getline(headerStream, var, ';'))
+    {
+        if (!var.empty())
+        {
+            keys.push_back(var);
+        }
+    }
+
+    if (keys.empty())
+    {
+        return false;
+    }
+
+    while (getline(file, line))
+    {
+        if (line[0] == '#' || line[0] == '\0')
+        {
+            continue;
+        }
+
+        std::stringstream lineStream(line);
+        std::map<std::string, std::string> memberConfiguration = parcelConfiguration;
+
+        for (const std::string& key : keys)
+        {
+            if (!getline(lineStream, var, ';'))
+            {
+                return false;
+            }
+
+            memberConfiguration[key] = var;
+        }
+
+        memberConfiguration["output_filename"] = getMemberOutputFileName(parcelConfiguration.at("output_filename"), memberConfigurations.size());
+        memberConfigurations.push_back(memberConfiguration);
+    }
+
+    return true;
+}
+
+std::string Ensemble::getMemberOutputFileName(const std::string& outputFileName, size_t memberIndex)
+{
+    //insert zero-padded member index before the file extension
+    std::stringstream suffix;
+    suffix << "_" << std::setw(4) << std::setfill('0') << memberIndex;
+
+    size_t extensionStart = outputFileName.find_last_of('.');
+    size_t directoryEnd = outputFileName.find_last_of('/');
+
+    if (extensionStart == std::string::npos || (directoryEnd != std::string::npos && extensionStart < directoryEnd))
+    {
+        return outputFileName + suffix.str();
+    }
+
+    return outputFileName.substr(0, extensionStart) + suffix.str() + outputFileName.substr(extensionStart);
+}
+
+size_t Ensemble::size() const
+{
+    return memberConfigurations.size();
+}
+
+bool Ensemble::run()
+{
+    if (memberConfigurations.empty())
+    {
+        return false;
+    }
+
+    if (createDynamicScheme(memberModelConfigurations.front(), memberConfigurations.front(), environment) == nullptr)
+    {
+        std::cout << "Incorect value of dynamic_scheme in model.conf or pseudoadiabatic_scheme or floating_point in parcel.conf\n";
+        return false;
+    }
+
+    std::atomic<size_t> failedMembers(0);
+    std::mutex messageMutex;
+    ThreadPool pool(threadCount);
+
+    std::cout << "Starting the ensemble of " << memberConfigurations.size() << " parcels on " << pool.size() << " threads\n";
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    auto reportFailure = [this, &failedMembers, &messageMutex](size_t member, const std::string& reason)
+    {
+        std::lock_guard<std::mutex> lock(messageMutex);
+        std::cout << "Ensemble member " << member << " (" << memberConfigurations[member].at("output_filename") << ") failed: " << reason << "\n";
+        failedMembers++;
+    };
+
+    for (size_t i = 0; i < memberConfigurations.size(); i++)
+    {
+        pool.submit([this, i, reportFailure]()
+            {
+                try
+                {
+                    //counts of the member start with its setup
+                    INSTRUMENT_RESET();
+
+                    //every member gets its own scheme instance, the environment is shared read-only
+                    std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(memberModelConfigurations[i], memberConfigurations[i], environment);
+
+                    if (dynamicScheme == nullptr)
+                    {
+                        reportFailure(i, "incorect value of dynamic_scheme, pseudoadiabatic_scheme or floating_point");
+                        return;
+                    }
+
+                    Parcel parcel(environment, memberConfigurations[i]);
+
+                    parcel = dynamicScheme->runSimulationOn(parcel);
+
+                    if (!outputDataFrom(parcel))
+                    {
+                        reportFailure(i, "cannot write " + parcel.outputFileName);
+                    }
+
+                    INSTRUMENT_REPORT(parcel.outputFileName);
+                }
+                catch (const std::exception& error)
+                {
+                    reportFailure(i, error.what());
+                }
+            });
+    }
+
+    pool.waitForAll();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::cout << "Ensemble finished\n";
+
+    double duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+    double throughput = memberConfigurations.size() / (duration / 1000.0);
+
+    std::cout << std::fixed << std::setprecision(3) << "Elapsed ensemble time: " << duration << " ms\n";
+    std::cout << std::setprecision(1) << "Throughput: " << throughput << " parcels/s\n";
+
+    if (failedMembers > 0)
+    {
+        std::cout << failedMembers << " of " << memberConfigurations.size() << " ensemble members failed\n";
+        return false;
+    }
+
+    std::cout << "Model output in ./" << memberConfigurations.front().at("output_filename") << " and following\n";
+
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "environment.h"
+#include "parcel.h"
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+//runs many parcels against one loaded environment, members differ in their parcel (and possibly model) configuration
+class Ensemble
+{
+private:
+	const Environment& environment;
+	std::map<std::string, std::string> modelConfiguration, parcelConfiguration;
+	std::vector<std::map<std::string, std::string>> memberModelConfigurations, memberConfigurations;
+	size_t threadCount;
+
+	bool importMembersFrom(std::ifstream& file);
+
+public:
+	//members read from ensemble_filename, all sharing modelConfiguration
+	Ensemble(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+	//members given directly with their own model configuration, e.g. the points of a parameter sweep
+	Ensemble(const Environment& environment, const std::map<std::string, std::string>& modelConfiguration, const std::vector<std::map<std::string, std::string>>& memberModelConfigurations, const std::vector<std::map<std::string, std::string>>& memberConfigurations);
+
+	static std::string getMemberOutputFileName(const std::string& outputFileName, size_t memberIndex);
+
+	size_t size() const;
+	bool run();
+};
+
+#endif
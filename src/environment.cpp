@@ -1,199 +1,255 @@
 #include "thermodynamic_calc.h"
 #include "environment.h"
+#include "profile_reader.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 
-std::vector<double> Environment::height;
-std::vector<double> Environment::pressure;
-std::vector<double> Environment::temperature;
-std::vector<double> Environment::dewpoint;
-double Environment::highestPoint;
-
 Sector::Sector()
 {
     lowerBoundary = 0;
     upperBoundary = 1;
 }
 
-Environment::Location::Location()
+template <class Real>
+BasicEnvironment<Real>::Location::Location()
 {
     sector = Sector();
     position = 0.0;
 }
 
-Environment::Environment(std::string configurationFileName)
+template <class Real>
+BasicEnvironment<Real>::BasicEnvironment(std::string configurationFileName) :
+    highestPoint(0.0),
+    sectorIndexOrigin(0.0),
+    sectorIndexScale(0.0)
 {
-    std::ifstream configurationFile(configurationFileName);
-    importDataFrom(configurationFile);
-    configurationFile.close();
+    readProfileFile(configurationFileName, height, pressure, temperature, dewpoint);
 
     highestPoint = height[height.size() - 1];
+
+    precomputeInterpolationTables();
+    buildSectorIndex();
 }
 
-void Environment::importDataFrom(std::ifstream& file)
+template <class Real>
+BasicEnvironment<Real>::BasicEnvironment(const ProfileArchive& archive, size_t column) :
+    highestPoint(0.0),
+    sectorIndexOrigin(0.0),
+    sectorIndexScale(0.0)
 {
-    std::string line;
+    archive.readColumn(column, height, pressure, temperature, dewpoint);
 
-    //dummy getlines for skipping the header lines
-    getline(file, line);
-    getline(file, line);
+    highestPoint = height[height.size() - 1];
 
-    //read variables line by line and push into separate vectors
-    while (getline(file, line))
-    {
-        std::stringstream lineStream(line);
-        std::string var;
-
-        getline(lineStream, var, ';');
-        height.push_back(stod(var));
-        getline(lineStream, var, ';');
-        pressure.push_back(stod(var));
-        getline(lineStream, var, ';');
-        temperature.push_back(stod(var));
-        getline(lineStream, var, ';');
-        dewpoint.push_back(stod(var));
-    }
+    precomputeInterpolationTables();
+    buildSectorIndex();
 }
 
-double Environment::getInterpolatedValueofFieldAtLocation(const std::vector<double>& variableField, const Location& location)
+template <class Real>
+template <class Other>
+BasicEnvironment<Real>::BasicEnvironment(const BasicEnvironment<Other>& other) :
+    highestPoint(0.0),
+    height(other.height),
+    pressure(other.pressure),
+    temperature(other.temperature),
+    dewpoint(other.dewpoint),
+    sectorIndexOrigin(0.0),
+    sectorIndexScale(0.0)
 {
-    //do linear interpolation of the field within the sector
-    double b = (variableField[location.sector.upperBoundary] - variableField[location.sector.lowerBoundary]) / (height[location.sector.upperBoundary] - height[location.sector.lowerBoundary]);
-    double a = variableField[location.sector.lowerBoundary] - (height[location.sector.lowerBoundary] * b);
+    //tables are rebuilt from the levels rather than rounded, so both precisions interpolate the same profile
+    highestPoint = height[height.size() - 1];
 
-    //caluclate and return pressure
-    return (a + (b * location.position));
+    precomputeInterpolationTables();
+    buildSectorIndex();
 }
 
-double Environment::getPressureAtLocation(const Location& location)
+template <class Real>
+void BasicEnvironment<Real>::precomputeInterpolationTables()
 {
-    //input in m; output in Pa
-    double value = getInterpolatedValueofFieldAtLocation(pressure, location);
-    
-    return value * 100.0;
+    //convert profile levels to SI units once, so lookups need no conversions
+    std::vector<double> levelPressure(height.size()), levelTemperature(height.size()), levelDewpoint(height.size()), levelMixingRatio(height.size()), levelVirtualTemperature(height.size());
 
+    for (size_t i = 0; i < height.size(); i++)
+    {
+        levelPressure[i] = pressure[i] * 100.0;
+        levelTemperature[i] = temperature[i] + 273.15;
+        levelDewpoint[i] = dewpoint[i] + 273.15;
+    }
+
+    //whole profile at once through the array kernels
+    calcMixingRatio(levelDewpoint.data(), levelPressure.data(), levelMixingRatio.data(), height.size());
+    calcVirtualTemperature(levelTemperature.data(), levelMixingRatio.data(), levelVirtualTemperature.data(), height.size());
+
+    pressureCoefficients = calcInterpolationCoefficients(height, levelPressure);
+    temperatureCoefficients = calcInterpolationCoefficients(height, levelTemperature);
+    dewpointCoefficients = calcInterpolationCoefficients(height, levelDewpoint);
+    virtualTemperatureCoefficients = calcInterpolationCoefficients(height, levelVirtualTemperature);
 }
 
-double Environment::getTemperatureAtLocation(const Location& location)
+template <class Real>
+std::vector<typename BasicEnvironment<Real>::InterpolationCoefficients> BasicEnvironment<Real>::calcInterpolationCoefficients(const std::vector<double>& heightField, const std::vector<double>& variableField)
 {
-    //input in m; output in K
-    double value = getInterpolatedValueofFieldAtLocation(temperature, location);
+    //one linear fit per sector, the last level repeats the topmost sector
+    std::vector<InterpolationCoefficients> coefficientsField(heightField.size());
 
-    return value + 273.15;
+    for (size_t i = 0; i + 1 < heightField.size(); i++)
+    {
+        double heightDelta = heightField[i + 1] - heightField[i];
 
+        if (heightDelta == 0.0)
+        {
+            //repeated level, keep the field constant
+            coefficientsField[i].slope = 0.0;
+            coefficientsField[i].intercept = variableField[i];
+            continue;
+        }
+
+        coefficientsField[i].slope = (variableField[i + 1] - variableField[i]) / heightDelta;
+        coefficientsField[i].intercept = variableField[i] - (heightField[i] * coefficientsField[i].slope);
+    }
+
+    if (heightField.size() > 1)
+    {
+        coefficientsField[heightField.size() - 1] = coefficientsField[heightField.size() - 2];
+    }
+
+    return coefficientsField;
 }
 
-double Environment::getDewpointAtLocation(const Location& location)
+template <class Real>
+Real BasicEnvironment<Real>::getInterpolatedValueofFieldAtLocation(const std::vector<InterpolationCoefficients>& coefficientsField, const Location& location) const
 {
-    //input in m; output in K
-    double value = getInterpolatedValueofFieldAtLocation(dewpoint, location);
+    //do linear interpolation of the field within the sector
+    INSTRUMENT_COUNT(environmentLookups);
+    const InterpolationCoefficients& coefficients = coefficientsField[location.sector.lowerBoundary];
 
-    return value + 273.15;
+    return coefficients.intercept + (coefficients.slope * location.position);
+}
 
+template <class Real>
+Real BasicEnvironment<Real>::getPressureAtLocation(const Location& location) const
+{
+    //input in m; output in Pa
+    return getInterpolatedValueofFieldAtLocation(pressureCoefficients, location);
 }
 
-double Environment::getVirtualTemperatureAtLocation(const Location& location)
+template <class Real>
+Real BasicEnvironment<Real>::getTemperatureAtLocation(const Location& location) const
 {
-    double press = getPressureAtLocation(location);
-    double temp = getTemperatureAtLocation(location);
-    double dwpt = getDewpointAtLocation(location);
+    //input in m; output in K
+    return getInterpolatedValueofFieldAtLocation(temperatureCoefficients, location);
+}
 
-    double mixr = calcMixingRatio(dwpt, press);
-    return calcVirtualTemperature(temp, mixr);
+template <class Real>
+Real BasicEnvironment<Real>::getDewpointAtLocation(const Location& location) const
+{
+    //input in m; output in K
+    return getInterpolatedValueofFieldAtLocation(dewpointCoefficients, location);
 }
 
-void Environment::Location::updateSector()
+template <class Real>
+Real BasicEnvironment<Real>::getVirtualTemperatureAtLocation(const Location& location) const
 {
-    //assuming sorted array of ascending values in heightField and location within bounds of heightField
+    //input in m; output in K
+    //interpolated between virtual temperatures of profile levels
+    return getInterpolatedValueofFieldAtLocation(virtualTemperatureCoefficients, location);
+}
 
-    size_t nearestPoint;
+template <class Real>
+void BasicEnvironment<Real>::buildSectorIndex()
+{
+    //bucket width follows the finest level spacing, so a bucket rarely contains more than one level
+    //bucket count is capped to keep the index small for profiles with a few very close levels
+    const size_t maxBucketsPerLevel = 16;
 
-    //check which sector boundary is closest
-    double distToUpper = abs(position - height[sector.upperBoundary]);
-    double distToLower = abs(position - height[sector.lowerBoundary]);
+    double minSpacing = highestPoint - height[0];
 
-    if (distToLower == distToUpper)
-    {
-        //no need for sector correction
-        return;
-    }
-    else if (distToLower < distToUpper)
+    for (size_t i = 0; i + 1 < height.size(); i++)
     {
-        if (sector.lowerBoundary == 0)
-        {
-            //location is in the lowest sector
-            sector.upperBoundary = 1;
-            return;
-        }
-
-        //move sector gradually down
-        nearestPoint = sector.lowerBoundary;
-        double dist = distToLower;
-        double newDist = abs(position - height[nearestPoint - 1]);
+        double spacing = height[i + 1] - height[i];
 
-        while (newDist < dist)
+        if (spacing > 0.0 && spacing < minSpacing)
         {
-            dist = newDist;
-            nearestPoint--;
-
-            if (nearestPoint > 0)
-            {
-                newDist = abs(position - height[nearestPoint - 1]);
-            }
-            else
-            {
-                sector.lowerBoundary = 0;
-                sector.upperBoundary = 1;
-                return;
-            }
+            minSpacing = spacing;
         }
     }
-    else if (distToLower > distToUpper)
+
+    double range = highestPoint - height[0];
+    size_t bucketCount = 1;
+
+    if (range > 0.0 && minSpacing > 0.0)
     {
-        if (sector.upperBoundary == (height.size() - 1))
-        {
-            //location is in the highest sector
-            sector.lowerBoundary = height.size() - 2;
-            return;
-        }
+        bucketCount = static_cast<size_t>(ceil(range / minSpacing));
+        bucketCount = std::min(std::max<size_t>(bucketCount, 1), maxBucketsPerLevel * height.size());
+    }
+
+    sectorIndexOrigin = height[0];
+    sectorIndexScale = (range > 0.0) ? bucketCount / range : 0.0;
+    sectorIndex.assign(bucketCount, 0);
 
-        //move sector gradually up
-        nearestPoint = sector.upperBoundary;
-        double dist = distToUpper;
-        double newDist = abs(position - height[nearestPoint + 1]);
+    //for each bucket store the highest level that falls into an earlier bucket
+    //bucket numbers are computed exactly as in findSector (in Real), so such a level never lies above a looked-up position
+    size_t lastSector = height.size() - 2;
+    size_t level = 0;
 
-        while (newDist < dist)
+    for (size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        while (level < lastSector && static_cast<size_t>(std::max((Real(height[level + 1]) - sectorIndexOrigin) * sectorIndexScale, Real(0.0))) < bucket)
         {
-            dist = newDist;
-            nearestPoint++;
-
-            if (nearestPoint < (height.size() - 1))
-            {
-                newDist = abs(position - height[nearestPoint + 1]);
-            }
-            else
-            {
-                sector.lowerBoundary = height.size() - 2;
-                sector.upperBoundary = height.size() - 1;
-                return;
-            }
+            level++;
         }
+
+        sectorIndex[bucket] = static_cast<uint32_t>(level);
     }
+}
 
-    double distToNearest = position - height[nearestPoint];
+template <class Real>
+Sector BasicEnvironment<Real>::findSector(Real position) const
+{
+    //sector whose lower boundary is the highest level at or below position, clamped to the profile
+    Sector sector;
+    Real bucketPosition = (position - sectorIndexOrigin) * sectorIndexScale;
 
-    if (distToNearest >= 0)
+    if (!(bucketPosition > 0.0))
     {
-        sector.lowerBoundary = nearestPoint;
-        sector.upperBoundary = nearestPoint + 1;
-        return;
+        return sector;
     }
-    else
+
+    size_t bucket = std::min(static_cast<size_t>(bucketPosition), sectorIndex.size() - 1);
+    size_t level = sectorIndex[bucket];
+    size_t lastSector = height.size() - 2;
+
+    while (level < lastSector && Real(height[level + 1]) <= position)
     {
-        sector.lowerBoundary = nearestPoint - 1;
-        sector.upperBoundary = nearestPoint;
-        return;
+        level++;
     }
-}
\ No newline at end of file
+
+    sector.lowerBoundary = level;
+    sector.upperBoundary = level + 1;
+
+    return sector;
+}
+
+template <class Real>
+void BasicEnvironment<Real>::Location::updateSector(const BasicEnvironment& environment)
+{
+    //constant-time lookup through the height bucket index
+#ifdef PARCEL_INSTRUMENTATION
+    size_t previousLowerBoundary = sector.lowerBoundary;
+#endif
+
+    sector = environment.findSector(position);
+
+    INSTRUMENT_COUNT(sectorUpdates);
+    INSTRUMENT_ADD(sectorMoves, sector.lowerBoundary != previousLowerBoundary ? 1 : 0);
+}
+
+template class BasicEnvironment<float>;
+template class BasicEnvironment<double>;
+
+template BasicEnvironment<float>::BasicEnvironment(const BasicEnvironment<double>& other);
@@ -1,11 +1,14 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+class ProfileArchive;
+
 struct Sector
 {
     size_t upperBoundary, lowerBoundary;
@@ -14,32 +17,60 @@ struct Sector
 };
 
 
-class Environment
+//profile lookups in the floating-point type of the simulation (floating_point in parcel.conf)
+//profile levels are kept in double, the interpolation tables and the sector index in Real
+template <class Real>
+class BasicEnvironment
 {
 
 public:
 	struct Location
 	{
-		double position;
+		Real position;
 		Sector sector;
 
 		Location();
-		void updateSector();
+		void updateSector(const BasicEnvironment& environment);
+	};
+
+	//linear fit a + b * height of a field within one sector, indexed by lower sector boundary
+	struct InterpolationCoefficients
+	{
+		Real slope, intercept;
 	};
 
-	static double highestPoint;
+	Real highestPoint;
 
-	static std::vector<double> height, pressure, temperature, dewpoint;
+	std::vector<double> height, pressure, temperature, dewpoint;
 
-	Environment(std::string configurationFileName);
-	static double getPressureAtLocation(const Location& location);
-	static double getTemperatureAtLocation(const Location& location);
-	static double getDewpointAtLocation(const Location& location);
-	static double getVirtualTemperatureAtLocation(const Location& location);
+	//throws std::runtime_error when the profile cannot be read
+	BasicEnvironment(std::string configurationFileName);
+	//one column of a packed profile archive, levels are read straight from its mapping
+	BasicEnvironment(const ProfileArchive& archive, size_t column);
+	//same profile with the tables rebuilt in Real
+	template <class Other>
+	explicit BasicEnvironment(const BasicEnvironment<Other>& other);
+
+	Real getPressureAtLocation(const Location& location) const;
+	Real getTemperatureAtLocation(const Location& location) const;
+	Real getDewpointAtLocation(const Location& location) const;
+	Real getVirtualTemperatureAtLocation(const Location& location) const;
+	Sector findSector(Real position) const;
 
 private:
-	void importDataFrom(std::ifstream& file);
-	static double getInterpolatedValueofFieldAtLocation(const std::vector<double>& variableField, const Location& location);
+	//uniform height buckets, each holding the lowest candidate sector for heights inside it
+	std::vector<uint32_t> sectorIndex;
+	Real sectorIndexOrigin, sectorIndexScale;
+
+	//per-sector tables in SI units (Pa, K) precomputed at load
+	std::vector<InterpolationCoefficients> pressureCoefficients, temperatureCoefficients, dewpointCoefficients, virtualTemperatureCoefficients;
+
+	void precomputeInterpolationTables();
+	void buildSectorIndex();
+	static std::vector<InterpolationCoefficients> calcInterpolationCoefficients(const std::vector<double>& heightField, const std::vector<double>& variableField);
+	Real getInterpolatedValueofFieldAtLocation(const std::vector<InterpolationCoefficients>& coefficientsField, const Location& location) const;
 };
 
+using Environment = BasicEnvironment<double>;
+
 #endif
\ No newline at end of file
@@ -3,10 +3,22 @@
 #include "parcel.h"
 #include "dynamic_scheme.h"
 #include "pseudoadiabatic_scheme.h"
+#include "instrumentation.h"
+#include <type_traits>
+
+template <class Pseudoadiabat, class Real>
+FiniteDifferenceDynamics<Pseudoadiabat, Real>::FiniteDifferenceDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme) :
+	sourceEnvironment(environment),
+	convertedEnvironment(environment),
+	environment(convertedEnvironment.get()),
+	pseudoadiabaticScheme(pseudoadiabaticScheme)
+{
+}
 
-Parcel FiniteDifferenceDynamics::runSimulationOn(Parcel& passedParcel)
+template <class Pseudoadiabat, class Real>
+Parcel FiniteDifferenceDynamics<Pseudoadiabat, Real>::runSimulationOn(Parcel& passedParcel)
 {
-	parcel = passedParcel;
+	parcel = convertParcel(passedParcel, environment);
 
 	startFromInitialConditions();
 
@@ -16,14 +28,17 @@ Parcel FiniteDifferenceDynamics::runSimulationOn(Parcel& passedParcel)
 		ascentAlongPseudoAdiabat();
 	}
 
-	return parcel;
+	return convertParcel(parcel, sourceEnvironment);
 }
 
-void FiniteDifferenceDynamics::ascentAlongMoistAdiabat()
+template <class Pseudoadiabat, class Real>
+void FiniteDifferenceDynamics<Pseudoadiabat, Real>::ascentAlongMoistAdiabat()
 {
+	INSTRUMENT_PHASE(moistAdiabat);
+
 	//calculate ascent constants
-	double gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
-	double lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
+	Real gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
+	Real lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
 
 	//loop through next timesteps
 	do
@@ -37,6 +52,7 @@ void FiniteDifferenceDynamics::ascentAlongMoistAdiabat()
 
 		//update parcel properties
 		parcel.currentTimeStep++;
+		INSTRUMENT_COUNT(timesteps);
 		parcel.updateCurrentDynamicsAndPressure();
 		parcel.updateCurrentThermodynamicsAdiabatically(lambda, gamma);
 	} while (parcel.mixingRatioSaturated[parcel.currentTimeStep] > parcel.mixingRatio[parcel.currentTimeStep]);
@@ -45,13 +61,13 @@ void FiniteDifferenceDynamics::ascentAlongMoistAdiabat()
 	parcel.mixingRatio[parcel.currentTimeStep] = parcel.mixingRatioSaturated[parcel.currentTimeStep];
 }
 
-void FiniteDifferenceDynamics::ascentAlongPseudoAdiabat()
+template <class Pseudoadiabat, class Real>
+void FiniteDifferenceDynamics<Pseudoadiabat, Real>::ascentAlongPseudoAdiabat()
 {
-	//create pseudodynamic scheme
-	std::unique_ptr<PseudoAdiabaticScheme> pseudoadiabaticScheme = choosePseudoAdiabaticScheme();
+	INSTRUMENT_PHASE(pseudoAdiabat);
 
 	//calculate wet-bulb potential temperature for pseudoadiabatic ascent
-	double wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
+	Real wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
 
 	//loop through timesteps until point of no moisture
 	while (parcel.mixingRatio[parcel.currentTimeStep] > parcel.noMoistureTreshold && parcel.velocity[parcel.currentTimeStep] > 0)
@@ -64,17 +80,19 @@ void FiniteDifferenceDynamics::ascentAlongPseudoAdiabat()
 		makeTimeStep();
 
 		parcel.currentTimeStep++;
+		INSTRUMENT_COUNT(timesteps);
 		parcel.updateCurrentDynamicsAndPressure();
-		double pressureDelta = parcel.pressure[parcel.currentTimeStep] - parcel.pressure[parcel.currentTimeStep - 1];
-		parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme->calculateCurrentPseudoadiabaticTemperature(parcel.getSlice(-1), pressureDelta, wetBulbPotentialTemp);
+		Real pressureDelta = parcel.pressure[parcel.currentTimeStep] - parcel.pressure[parcel.currentTimeStep - 1];
+		parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(parcel.getSlice(-1), pressureDelta, wetBulbPotentialTemp);
 		parcel.updateCurrentThermodynamicsPseudoadiabatically();
 	}
 }
 
-void FiniteDifferenceDynamics::startFromInitialConditions()
+template <class Pseudoadiabat, class Real>
+void FiniteDifferenceDynamics<Pseudoadiabat, Real>::startFromInitialConditions()
 {
-	double gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
-	double lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
+	Real gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
+	Real lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
 
 	if (!isParcelWithinBounds())
 	{
@@ -85,49 +103,43 @@ void FiniteDifferenceDynamics::startFromInitialConditions()
 
 	//update parcel properties
 	parcel.currentTimeStep++;
+	INSTRUMENT_COUNT(timesteps);
 	parcel.updateCurrentDynamicsAndPressure();
 	parcel.updateCurrentThermodynamicsAdiabatically(lambda, gamma);
 }
 
-void FiniteDifferenceDynamics::makeFirstTimeStep()
+template <class Pseudoadiabat, class Real>
+void FiniteDifferenceDynamics<Pseudoadiabat, Real>::makeFirstTimeStep()
 {
 	parcel.position[1] = parcel.position[0] + (parcel.velocity[0] * parcel.timeDelta);
 	parcel.velocity[1] = (parcel.position[1] - parcel.position[0]) / parcel.timeDelta;
 }
 
-void FiniteDifferenceDynamics::makeTimeStep()
+template <class Pseudoadiabat, class Real>
+void FiniteDifferenceDynamics<Pseudoadiabat, Real>::makeTimeStep()
 {
-	double bouyancyForce = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], Environment::getVirtualTemperatureAtLocation(parcel.currentLocation));
-
-	parcel.position[parcel.currentTimeStep + 1] = (parcel.timeDeltaSquared * bouyancyForce) + (2.0 * parcel.position[parcel.currentTimeStep]) - parcel.position[parcel.currentTimeStep - 1];
-	parcel.velocity[parcel.currentTimeStep + 1] = (parcel.position[parcel.currentTimeStep + 1] - parcel.position[parcel.currentTimeStep]) / parcel.timeDelta;
-}
+	INSTRUMENT_TIMER(stepTime);
+	INSTRUMENT_COUNT(stageEvaluations);
 
-std::unique_ptr<PseudoAdiabaticScheme> FiniteDifferenceDynamics::choosePseudoAdiabaticScheme()
-{
-	size_t pseudoadiabaticSchemeID = std::stoi(parcel.parcelConfiguration.at("pseudoadiabatic_scheme"));
+	Real bouyancyForce = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], environment.getVirtualTemperatureAtLocation(parcel.currentLocation));
 
-	if (pseudoadiabaticSchemeID == 1)
-	{
-		return std::make_unique<FiniteDifferencePseudoadiabat>();
-	}
-	else if (pseudoadiabaticSchemeID == 2)
-	{
-		return std::make_unique<RungeKuttaPseudoadiabat>();
-	}
-	else if (pseudoadiabaticSchemeID == 3)
+	if constexpr (std::is_same<Real, float>::value)
 	{
-		return std::make_unique<NumericalPseudoadiabat>();
-	}
-	else
-	{
-		return nullptr;
+		//float positions are too coarse for the second difference (dt^2 * B is below their resolution a few km up),
+		//so the velocity is carried instead, the same recurrence in exact arithmetic
+		parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + (parcel.timeDelta * bouyancyForce);
+		parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + (parcel.timeDelta * parcel.velocity[parcel.currentTimeStep + 1]);
+		return;
 	}
+
+	parcel.position[parcel.currentTimeStep + 1] = (parcel.timeDeltaSquared * bouyancyForce) + (Real(2.0) * parcel.position[parcel.currentTimeStep]) - parcel.position[parcel.currentTimeStep - 1];
+	parcel.velocity[parcel.currentTimeStep + 1] = (parcel.position[parcel.currentTimeStep + 1] - parcel.position[parcel.currentTimeStep]) / parcel.timeDelta;
 }
 
-bool FiniteDifferenceDynamics::isParcelWithinBounds()
+template <class Pseudoadiabat, class Real>
+bool FiniteDifferenceDynamics<Pseudoadiabat, Real>::isParcelWithinBounds()
 {
-	if (parcel.position[parcel.currentTimeStep] >= Environment::highestPoint)
+	if (parcel.position[parcel.currentTimeStep] >= environment.highestPoint)
 	{
 		return false;
 	}
@@ -144,4 +156,14 @@ bool FiniteDifferenceDynamics::isParcelWithinBounds()
 		return true;
 	}
 
-}
\ No newline at end of file
+}
+
+template class FiniteDifferenceDynamics<FiniteDifferencePseudoadiabat, float>;
+template class FiniteDifferenceDynamics<RungeKuttaPseudoadiabat, float>;
+template class FiniteDifferenceDynamics<NumericalPseudoadiabat, float>;
+template class FiniteDifferenceDynamics<TablePseudoadiabat, float>;
+
+template class FiniteDifferenceDynamics<FiniteDifferencePseudoadiabat, double>;
+template class FiniteDifferenceDynamics<RungeKuttaPseudoadiabat, double>;
+template class FiniteDifferenceDynamics<NumericalPseudoadiabat, double>;
+template class FiniteDifferenceDynamics<TablePseudoadiabat, double>;
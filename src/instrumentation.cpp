@@ -0,0 +1,82 @@
+#include "instrumentation.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    const char* const phaseNames[instrumentation::phaseCount] = { "setup", "moist_adiabat", "pseudo_adiabat" };
+    const char* const counterNames[instrumentation::counterCount] = { "timesteps", "stage_evaluations", "pseudoadiabat_calls", "environment_lookups", "sector_updates", "sector_moves" };
+    const char* const timerNames[instrumentation::timerCount] = { "phase_ms", "step_ms" };
+
+    void writeValues(std::ofstream& file, uint64_t entries, const uint64_t* counts, const double* nanoseconds)
+    {
+        char value[64];
+
+        file << "{ \"entries\": " << entries;
+
+        for (size_t timer = 0; timer < instrumentation::timerCount; timer++)
+        {
+            std::snprintf(value, sizeof(value), "%.3f", nanoseconds[timer] / 1e6);
+            file << ", \"" << timerNames[timer] << "\": " << value;
+        }
+
+        for (size_t counter = 0; counter < instrumentation::counterCount; counter++)
+        {
+            file << ", \"" << counterNames[counter] << "\": " << counts[counter];
+        }
+
+        file << " }";
+    }
+}
+
+void instrumentation::reset()
+{
+    record = Record();
+    currentPhase = setup;
+}
+
+bool instrumentation::writeReport(const std::string& outputFileName)
+{
+    //report name replaces the extension of the output file
+    size_t extensionStart = outputFileName.find_last_of('.');
+    size_t directoryEnd = outputFileName.find_last_of('/');
+    bool hasExtension = extensionStart != std::string::npos && (directoryEnd == std::string::npos || extensionStart > directoryEnd);
+    std::string reportFileName = (hasExtension ? outputFileName.substr(0, extensionStart) : outputFileName) + ".instrumentation.json";
+
+    std::ofstream file(reportFileName);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    Record total = {};
+
+    file << "{\n  \"output\": \"" << outputFileName << "\",\n  \"phases\": {\n";
+
+    for (size_t phase = 0; phase < phaseCount; phase++)
+    {
+        total.entries[0] += record.entries[phase];
+
+        for (size_t counter = 0; counter < counterCount; counter++)
+        {
+            total.counts[0][counter] += record.counts[phase][counter];
+        }
+
+        for (size_t timer = 0; timer < timerCount; timer++)
+        {
+            total.nanoseconds[0][timer] += record.nanoseconds[phase][timer];
+        }
+
+        file << "    \"" << phaseNames[phase] << "\": ";
+        writeValues(file, record.entries[phase], record.counts[phase], record.nanoseconds[phase]);
+        file << (phase + 1 < phaseCount ? ",\n" : "\n");
+    }
+
+    file << "  },\n  \"total\": ";
+    writeValues(file, total.entries[0], total.counts[0], total.nanoseconds[0]);
+    file << "\n}\n";
+
+    return file.good();
+}
@@ -0,0 +1,114 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//optional hot-path counters and phase timers, compiled in only with -DPARCEL_INSTRUMENTATION (make all INSTRUMENTATION=1)
+//records are thread-local, so every ensemble, batch or sweep run is counted on the thread that simulates it
+namespace instrumentation
+{
+	enum Phase
+	{
+		setup, //initial conditions and anything outside the ascent phases
+		moistAdiabat,
+		pseudoAdiabat,
+		phaseCount
+	};
+
+	enum Counter
+	{
+		timesteps,
+		stageEvaluations, //buoyancy evaluations of the dynamic schemes
+		pseudoadiabatCalls,
+		environmentLookups,
+		sectorUpdates,
+		sectorMoves, //sector updates that changed the sector
+		counterCount
+	};
+
+	enum Timer
+	{
+		phaseTime,
+		stepTime, //inside the timestep functions of the dynamic schemes
+		timerCount
+	};
+
+	struct Record
+	{
+		uint64_t entries[phaseCount];
+		uint64_t counts[phaseCount][counterCount];
+		double nanoseconds[phaseCount][timerCount];
+	};
+
+	inline thread_local Record record = {};
+	inline thread_local Phase currentPhase = setup;
+
+	//attributes everything inside its scope to phase and times it
+	class PhaseScope
+	{
+	public:
+		PhaseScope(Phase phase) :
+			phase(phase),
+			previousPhase(currentPhase),
+			startTime(std::chrono::steady_clock::now())
+		{
+			currentPhase = phase;
+			record.entries[phase]++;
+		}
+
+		~PhaseScope()
+		{
+			record.nanoseconds[phase][phaseTime] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+			currentPhase = previousPhase;
+		}
+
+	private:
+		Phase phase, previousPhase;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	//adds the time spent in its scope to timer of the current phase
+	class TimerScope
+	{
+	public:
+		TimerScope(Timer timer) :
+			timer(timer),
+			startTime(std::chrono::steady_clock::now())
+		{
+		}
+
+		~TimerScope()
+		{
+			record.nanoseconds[currentPhase][timer] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+		}
+
+	private:
+		Timer timer;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	void reset();
+
+	//JSON report of the current thread's record, written next to the run output as <output name>.instrumentation.json
+	bool writeReport(const std::string& outputFileName);
+}
+
+#ifdef PARCEL_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter) (instrumentation::record.counts[instrumentation::currentPhase][instrumentation::counter]++)
+#define INSTRUMENT_ADD(counter, amount) (instrumentation::record.counts[instrumentation::currentPhase][instrumentation::counter] += (amount))
+#define INSTRUMENT_PHASE(phase) instrumentation::PhaseScope instrumentedPhase(instrumentation::phase)
+#define INSTRUMENT_TIMER(timer) instrumentation::TimerScope instrumentedTimer(instrumentation::timer)
+#define INSTRUMENT_RESET() instrumentation::reset()
+#define INSTRUMENT_REPORT(outputFileName) instrumentation::writeReport(outputFileName)
+#else
+#define INSTRUMENT_COUNT(counter) ((void)0)
+#define INSTRUMENT_ADD(counter, amount) ((void)0)
+#define INSTRUMENT_PHASE(phase) ((void)0)
+#define INSTRUMENT_TIMER(timer) ((void)0)
+#define INSTRUMENT_RESET() ((void)0)
+#define INSTRUMENT_REPORT(outputFileName) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+#include "environment.h"
+#include "parcel.h"
+#include "parcel_summary.h"
+#include "dynamic_scheme.h"
+#include "output.h"
+#include "trajectory_decimation.h"
+#include "trajectory_field.h"
+#include "libparcel.h"
+#include "libparcel_c.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string formatValue(double value)
+    {
+        std::stringstream valueStream;
+        valueStream.precision(17);
+        valueStream << value;
+
+        return valueStream.str();
+    }
+
+    //same diagnostics as output_mode=summary, from the rows of a trajectory table
+    ParcelSummary calcSummaryOf(const SimulationResult& result, const Environment& environment)
+    {
+        auto findColumn = [&result](const std::string& name)
+        {
+            return &result.columns[std::find(result.columnNames.begin(), result.columnNames.end(), name) - result.columnNames.begin()];
+        };
+
+        const std::vector<double>& position = *findColumn("position");
+        const std::vector<double>& velocity = *findColumn("velocity");
+        const std::vector<double>& pressure = *findColumn("pressure");
+        const std::vector<double>& temperatureVirtual = *findColumn("virtual_temperature");
+        const std::vector<double>& mixingRatio = *findColumn("mixing_ratio");
+        const std::vector<double>& mixingRatioSaturated = *findColumn("saturation_mixing_ratio");
+
+        ParcelSummary summary;
+        Environment::Location location;
+
+        for (size_t i = 0; i < result.rows; i++)
+        {
+            location.position = position[i];
+            location.updateSector(environment);
+
+            double bouyancy = calcBouyancyForce(temperatureVirtual[i], environment.getVirtualTemperatureAtLocation(location));
+            summary.addStep(position[i], velocity[i], pressure[i], bouyancy, mixingRatio[i] >= mixingRatioSaturated[i]);
+        }
+
+        return summary;
+    }
+
+    thread_local std::string lastError;
+}
+
+SimulationResult simulate(const Environment& environment, const InitialConditions& initialConditions, const SimulationOptions& options)
+{
+    //the options become the configuration maps the model reads everywhere else
+    std::map<std::string, std::string> modelConfiguration = {
+        { "dynamic_scheme", std::to_string(options.dynamicScheme) },
+        { "adaptive_tolerance", formatValue(options.adaptiveTolerance) } };
+
+    std::map<std::string, std::string> parcelConfiguration = options.parcelConfiguration;
+    parcelConfiguration["output_filename"] = "";
+    parcelConfiguration["output_mode"] = options.outputMode;
+    parcelConfiguration["thermo_precision"] = options.thermoPrecision;
+    parcelConfiguration["floating_point"] = options.floatingPoint;
+    parcelConfiguration["pseudoadiabatic_scheme"] = std::to_string(options.pseudoadiabaticScheme);
+    parcelConfiguration["timestep"] = formatValue(options.timestep);
+    parcelConfiguration["period"] = formatValue(options.period);
+    parcelConfiguration["no_moisture_trsh"] = formatValue(options.noMoistureTreshold);
+    parcelConfiguration["init_height"] = formatValue(initialConditions.height);
+    parcelConfiguration["init_velocity"] = formatValue(initialConditions.velocity);
+    parcelConfiguration["init_temp"] = formatValue(initialConditions.temperature);
+    parcelConfiguration["init_dewpoint"] = formatValue(initialConditions.dewpoint);
+
+    std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(modelConfiguration, parcelConfiguration, environment);
+
+    if (dynamicScheme == nullptr)
+    {
+        throw std::invalid_argument("incorect value of dynamicScheme, pseudoadiabaticScheme or floatingPoint");
+    }
+
+    Parcel parcel(environment, parcelConfiguration);
+    parcel = dynamicScheme->runSimulationOn(parcel);
+
+    //chunks of every column are gathered into one contiguous array
+    std::vector<TrajectoryField> summaryValues;
+    TrajectoryDecimation decimatedTrajectory;
+    OutputTable table = getResultTableOf(parcel, summaryValues, decimatedTrajectory);
+    SimulationResult result;
+
+    result.rows = table.rows;
+
+    for (const OutputColumn& column : table.columns)
+    {
+        std::vector<double> values(table.rows);
+
+        for (size_t start = 0; start < table.rows; start += TrajectoryField::chunkSize)
+        {
+            size_t length = std::min(TrajectoryField::chunkSize, table.rows - start);
+            std::memcpy(values.data() + start, column.values->getChunk(start >> TrajectoryField::chunkShift), length * sizeof(double));
+        }
+
+        result.columnNames.push_back(column.name);
+        result.columns.push_back(std::move(values));
+    }
+
+    result.summary = parcel.isSummaryOnly ? parcel.getSummary() : calcSummaryOf(result, environment);
+
+    return result;
+}
+
+struct parcel_environment
+{
+    Environment environment;
+
+    parcel_environment(const char* profileFileName) : environment(profileFileName) {}
+};
+
+struct parcel_result
+{
+    SimulationResult result;
+};
+
+void parcel_default_initial_conditions(parcel_initial_conditions* initial_conditions)
+{
+    if (initial_conditions == nullptr)
+    {
+        return;
+    }
+
+    InitialConditions defaults;
+    *initial_conditions = { defaults.height, defaults.velocity, defaults.temperature, defaults.dewpoint };
+}
+
+void parcel_default_options(parcel_options* options)
+{
+    if (options == nullptr)
+    {
+        return;
+    }
+
+    SimulationOptions defaults;
+    *options = { defaults.dynamicScheme, defaults.pseudoadiabaticScheme, defaults.timestep, defaults.period, defaults.noMoistureTreshold, defaults.adaptiveTolerance, 0, 0, 0 };
+}
+
+const char* parcel_last_error(void)
+{
+    return lastError.c_str();
+}
+
+parcel_environment* parcel_load_environment(const char* profile_file_name)
+{
+    if (profile_file_name == nullptr)
+    {
+        lastError = "profile file name is required";
+        return nullptr;
+    }
+
+    //exceptions never cross the C boundary
+    try
+    {
+        return new parcel_environment(profile_file_name);
+    }
+    catch (const std::exception& error)
+    {
+        lastError = error.what();
+        return nullptr;
+    }
+}
+
+void parcel_free_environment(parcel_environment* environment)
+{
+    delete environment;
+}
+
+parcel_result* parcel_simulate(const parcel_environment* environment, const parcel_initial_conditions* initial_conditions, const parcel_options* options)
+{
+    if (environment == nullptr || initial_conditions == nullptr || options == nullptr)
+    {
+        lastError = "environment, initial conditions and options are required";
+        return nullptr;
+    }
+
+    try
+    {
+        InitialConditions initialConditions;
+        initialConditions.height = initial_conditions->height;
+        initialConditions.velocity = initial_conditions->velocity;
+        initialConditions.temperature = initial_conditions->temperature;
+        initialConditions.dewpoint = initial_conditions->dewpoint;
+
+        SimulationOptions simulationOptions;
+        simulationOptions.dynamicScheme = options->dynamic_scheme;
+        simulationOptions.pseudoadiabaticScheme = options->pseudoadiabatic_scheme;
+        simulationOptions.timestep = options->timestep;
+        simulationOptions.period = options->period;
+        simulationOptions.noMoistureTreshold = options->no_moisture_treshold;
+        simulationOptions.adaptiveTolerance = options->adaptive_tolerance;
+        simulationOptions.outputMode = options->summary_only ? "summary" : "trajectory";
+        simulationOptions.thermoPrecision = options->fast_thermodynamics ? "fast" : "exact";
+        simulationOptions.floatingPoint = options->single_precision ? "float" : "double";
+
+        std::unique_ptr<parcel_result> result = std::make_unique<parcel_result>();
+        result->result = simulate(environment->environment, initialConditions, simulationOptions);
+
+        return result.release();
+    }
+    catch (const std::exception& error)
+    {
+        lastError = error.what();
+        return nullptr;
+    }
+}
+
+void parcel_free_result(parcel_result* result)
+{
+    delete result;
+}
+
+//accessors of a NULL result return 0, NULL, -1, an empty view or NaN
+size_t parcel_result_rows(const parcel_result* result)
+{
+    return result != nullptr ? result->result.rows : 0;
+}
+
+size_t parcel_result_column_count(const parcel_result* result)
+{
+    return result != nullptr ? result->result.columns.size() : 0;
+}
+
+const char* parcel_result_column_name(const parcel_result* result, size_t column)
+{
+    return result != nullptr && column < result->result.columnNames.size() ? result->result.columnNames[column].c_str() : nullptr;
+}
+
+long parcel_result_find_column(const parcel_result* result, const char* name)
+{
+    if (result == nullptr || name == nullptr)
+    {
+        return -1;
+    }
+
+    const std::vector<std::string>& names = result->result.columnNames;
+    auto found = std::find(names.begin(), names.end(), name);
+
+    return found != names.end() ? static_cast<long>(found - names.begin()) : -1;
+}
+
+parcel_column_view parcel_result_column(const parcel_result* result, size_t column)
+{
+    if (result == nullptr || column >= result->result.columns.size())
+    {
+        return { nullptr, 0 };
+    }
+
+    return { result->result.columns[column].data(), result->result.rows };
+}
+
+double parcel_result_cape(const parcel_result* result)
+{
+    return result != nullptr ? result->result.summary.cape : std::numeric_limits<double>::quiet_NaN();
+}
+
+double parcel_result_cin(const parcel_result* result)
+{
+    return result != nullptr ? result->result.summary.cin : std::numeric_limits<double>::quiet_NaN();
+}
+
+double parcel_result_max_velocity(const parcel_result* result)
+{
+    return result != nullptr ? result->result.summary.maxVelocity : std::numeric_limits<double>::quiet_NaN();
+}
+
+double parcel_result_cloud_top_height(const parcel_result* result)
+{
+    return result != nullptr ? result->result.summary.cloudTopHeight : std::numeric_limits<double>::quiet_NaN();
+}
@@ -0,0 +1,53 @@
+#ifndef LIBPARCEL_H
+#define LIBPARCEL_H
+
+#include "environment.h"
+#include "parcel_summary.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+//in-process interface of the model (libparcel.a and libparcel.so, built with make lib), no configuration or output files involved
+//the C interface for other languages is in libparcel_c.h
+
+//initial state of the parcel, in m, m/s and C as in parcel.conf
+struct InitialConditions
+{
+	double height = 100.0;
+	double velocity = 0.0;
+	double temperature = 33.0;
+	double dewpoint = 19.0;
+};
+
+//numerical settings with the meaning of the model.conf and parcel.conf keys of the same name
+struct SimulationOptions
+{
+	int dynamicScheme = 2;
+	int pseudoadiabaticScheme = 2;
+	double timestep = 0.1; //s
+	double period = 2.0; //h
+	double noMoistureTreshold = 0.00001;
+	double adaptiveTolerance = 1e-6;
+	std::string outputMode = "trajectory"; //trajectory or summary
+	std::string thermoPrecision = "exact"; //exact or fast
+	std::string floatingPoint = "double"; //double or float
+
+	//any other parcel.conf keys, e.g. output_decimation, output_interval or pseudoadiabat_table_cache
+	std::map<std::string, std::string> parcelConfiguration;
+};
+
+//columns of the output table (as written to the output file) in contiguous storage, plus the parcel diagnostics
+//outside output_mode=summary the diagnostics are integrated over the rows of the table, so decimated output gives coarser values
+struct SimulationResult
+{
+	std::vector<std::string> columnNames;
+	std::vector<std::vector<double>> columns;
+	size_t rows = 0;
+	ParcelSummary summary;
+};
+
+//throws std::invalid_argument for an unknown scheme
+SimulationResult simulate(const Environment& environment, const InitialConditions& initialConditions, const SimulationOptions& options);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef LIBPARCEL_C_H
+#define LIBPARCEL_C_H
+
+#include <stddef.h>
+
+/* C interface of libparcel, every function is safe to call from C and other languages with a C FFI */
+/* functions returning a pointer return NULL on failure, parcel_last_error then describes it (per thread) */
+/* NULL arguments are accepted: result accessors then return 0, NULL, -1, an empty view or NaN */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct parcel_environment parcel_environment;
+typedef struct parcel_result parcel_result;
+
+/* initial state in m, m/s and C */
+typedef struct
+{
+	double height;
+	double velocity;
+	double temperature;
+	double dewpoint;
+} parcel_initial_conditions;
+
+/* scheme numbers as in model.conf and parcel.conf; summary_only, fast_thermodynamics and single_precision are 0 or 1 */
+typedef struct
+{
+	int dynamic_scheme;
+	int pseudoadiabatic_scheme;
+	double timestep;
+	double period;
+	double no_moisture_treshold;
+	double adaptive_tolerance;
+	int summary_only;
+	int fast_thermodynamics;
+	int single_precision;
+} parcel_options;
+
+/* view of one result column, valid until the result is freed */
+typedef struct
+{
+	const double* data;
+	size_t length;
+} parcel_column_view;
+
+void parcel_default_initial_conditions(parcel_initial_conditions* initial_conditions);
+void parcel_default_options(parcel_options* options);
+const char* parcel_last_error(void);
+
+parcel_environment* parcel_load_environment(const char* profile_file_name);
+void parcel_free_environment(parcel_environment* environment);
+
+/* one environment may be used by many simulations at once from different threads */
+parcel_result* parcel_simulate(const parcel_environment* environment, const parcel_initial_conditions* initial_conditions, const parcel_options* options);
+void parcel_free_result(parcel_result* result);
+
+size_t parcel_result_rows(const parcel_result* result);
+size_t parcel_result_column_count(const parcel_result* result);
+const char* parcel_result_column_name(const parcel_result* result, size_t column);
+/* index of the named column or -1 */
+long parcel_result_find_column(const parcel_result* result, const char* name);
+/* points into the result, nothing is copied; an empty view for a column out of range */
+parcel_column_view parcel_result_column(const parcel_result* result, size_t column);
+
+double parcel_result_cape(const parcel_result* result);
+double parcel_result_cin(const parcel_result* result);
+double parcel_result_max_velocity(const parcel_result* result);
+double parcel_result_cloud_top_height(const parcel_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
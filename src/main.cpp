@@ -3,121 +3,127 @@
 #include "parcel.h"
 #include "pseudoadiabatic_scheme.h"
 #include "dynamic_scheme.h"
+#include "ensemble.h"
+#include "batch.h"
+#include "convergence.h"
+#include "server.h"
+#include "configuration.h"
+#include "output.h"
+#include "instrumentation.h"
 #include <chrono>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
-//define functions
-
-std::map<std::string, std::string> readConfigurationFromFile(std::string filename)
+int main()
 {
-    std::map<std::string, std::string> config;
-    std::ifstream configFile("config/" + filename);
-    std::string line;
+    //read model and parcel configuration
+    const std::map<std::string, std::string> modelConfiguration = readConfigurationFromFile("model.conf");
+    const std::map<std::string, std::string> parcelConfiguration = readConfigurationFromFile("parcel.conf");
 
-    std::cout << "Reading configuration file " << filename << "\n";
+    //ranges and lists of numeric values expand into a parameter sweep of runs
+    ParameterSweep sweep;
 
-    //read file into a map
-    while (getline(configFile, line))
+    try
     {
-        if (line[0] != '#' && line[0] != '\n' && line[0] != '\0') //read only lines containing variables
-        {
-            std::stringstream lineStream(line);
-            std::string key, value;
+        sweep = expandParameterSweep(modelConfiguration, parcelConfiguration);
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << "Invalid parameter sweep: " << error.what() << "\n";
+        return -1;
+    }
 
-            getline(lineStream, key, '=');
-            getline(lineStream, value, '=');
+    const bool isSingleRun = modelConfiguration.find("run_mode") == modelConfiguration.end() || modelConfiguration.at("run_mode") == "single";
 
-            config.insert({ key, value });
-        }
+    if (sweep.size() > 1 && !isSingleRun)
+    {
+        std::cout << "Parameter sweeps need run_mode=single in model.conf\n";
+        return -1;
     }
 
-    if(config.find("profile_filename") != config.end())
+    //simulate every profile of a directory or manifest, each batch task loads its own environment
+    if (modelConfiguration.find("run_mode") != modelConfiguration.end() && modelConfiguration.at("run_mode") == "batch")
     {
-        config["profile_filename"] = "input/" + config["profile_filename"];
+        Batch batch(modelConfiguration, parcelConfiguration);
+        return batch.run() ? 0 : -1;
     }
-        
 
-    if (config.find("output_filename") != config.end())
+    //keep serving parcel requests, profiles are loaded on demand and cached
+    if (modelConfiguration.find("run_mode") != modelConfiguration.end() && modelConfiguration.at("run_mode") == "server")
     {
-        config["output_filename"] = "output/" + config["output_filename"];
+        SimulationServer server(modelConfiguration, parcelConfiguration);
+        return server.run() ? 0 : -1;
     }
-       
-    configFile.close();
 
-    return config;
-}
-
-void outputDataFrom(const Parcel& parcel)
-{
-    std::ofstream output(parcel.outputFileName);
+    //create environment from given profile file
+    std::unique_ptr<const Environment> loadedEnvironment;
 
-    if (!output.is_open())
+    try
     {
-        std::cout << "Directory ./output must exits. Please create it!\n";
-        return;
+        loadedEnvironment = std::make_unique<const Environment>(modelConfiguration.at("profile_filename"));
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << "Cannot load the profile: " << error.what() << "\n";
+        return -1;
     }
 
-    output << std::fixed << std::setprecision(5);
-
-    output << "position; velocity; pressure; temperature; virtual_temperature; mixing_ratio; saturation_mixing_ratio;" << "\n";
+    const Environment& environment = *loadedEnvironment;
 
-    for (size_t i = 0; i < parcel.ascentSteps; i++)
+    //run many initial conditions at once when ensemble mode is requested
+    if (modelConfiguration.find("run_mode") != modelConfiguration.end() && modelConfiguration.at("run_mode") == "ensemble")
     {
-        if (parcel.position[i] == -999.0)
-        {
-            break;
-        }
+        Ensemble ensemble(environment, modelConfiguration, parcelConfiguration);
+        return ensemble.run() ? 0 : -1;
+    }
 
-        output << parcel.position[i] << "; "
-            << parcel.velocity[i] << "; "
-            << parcel.pressure[i] << "; "
-            << parcel.temperature[i] << "; "
-            << parcel.temperatureVirtual[i] << "; "
-            << parcel.mixingRatio[i] << "; "
-            << parcel.mixingRatioSaturated[i] << ";" << "\n";
+    //compare scheme pairs over halved timesteps and recommend the largest accurate timestep
+    if (modelConfiguration.find("run_mode") != modelConfiguration.end() && modelConfiguration.at("run_mode") == "convergence")
+    {
+        ConvergenceStudy study(environment, modelConfiguration, parcelConfiguration);
+        return study.run() ? 0 : -1;
     }
 
-    output.close();
+    //all runs of a sweep share the loaded environment and execute in parallel like ensemble members
+    if (sweep.size() > 1)
+    {
+        std::cout << "Parameter sweep of " << sweep.size() << " runs over " << sweep.dimensions.size() << " parameters\n";
 
-    std::cout << "Model output in ./" + parcel.outputFileName + "\n";
-}
+        Ensemble sweepRuns(environment, modelConfiguration, sweep.modelConfigurations, sweep.parcelConfigurations);
+        bool isSweepDone = sweepRuns.run();
 
-int main()
-{
-    //read model and parcel configuration
-    const std::map<std::string, std::string> modelConfiguration = readConfigurationFromFile("model.conf");
-    const std::map<std::string, std::string> parcelConfiguration = readConfigurationFromFile("parcel.conf");
+        std::string indexFileName = std::filesystem::path(parcelConfiguration.at("output_filename")).replace_extension(".sweep").string();
 
-    //create environment from given profile file
-    Environment environment(modelConfiguration.at("profile_filename"));
+        if (!writeSweepIndex(indexFileName, sweep))
+        {
+            return -1;
+        }
+
+        std::cout << "Swept values of every run in ./" << indexFileName << "\n";
+        return isSweepDone ? 0 : -1;
+    }
+
+    //counts of the run start with the parcel setup
+    INSTRUMENT_RESET();
 
     //create parcel
-    Parcel parcel(parcelConfiguration);
+    Parcel parcel(environment, parcelConfiguration);
 
     //create instances of schemes
-    std::unique_ptr<DynamicScheme> dynamicScheme;
-
-    size_t dynamicSchemeID = std::stoi(modelConfiguration.at("dynamic_scheme"));
+    std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(modelConfiguration, parcelConfiguration, environment);
 
-    if (dynamicSchemeID == 1)
-    {
-        dynamicScheme = std::make_unique<FiniteDifferenceDynamics>();
-    }
-    else if (dynamicSchemeID == 2)
-    {
-        dynamicScheme = std::make_unique<RungeKuttaDynamics>();
-    }
-    else
+    if (dynamicScheme == nullptr)
     {
-        std::cout << "Incorect value of dynamic_scheme in model.conf\n";
+        std::cout << "Incorect value of dynamic_scheme in model.conf or pseudoadiabatic_scheme or floating_point in parcel.conf\n";
         return -1;
     }
 
@@ -132,6 +138,13 @@ int main()
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
     std::cout << std::fixed << std::setprecision(3) << "Elapsed simulation time: " << duration / 1000.0 << " ms\n";
 
-    outputDataFrom(parcel);
+    if (!outputDataFrom(parcel))
+    {
+        return -1;
+    }
+
+    INSTRUMENT_REPORT(parcel.outputFileName);
+
+    std::cout << "Model output in ./" + parcel.outputFileName + "\n";
     return 0;
 }
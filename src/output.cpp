@@ -0,0 +1,355 @@
+#include "parcel.h"
+#include "parcel_summary.h"
+#include "trajectory_decimation.h"
+#include "trajectory_field.h"
+#include "output.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool isHostLittleEndian()
+    {
+        const uint16_t probe = 1;
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+
+        return firstByte == 1;
+    }
+
+    //write value as little-endian bytes regardless of the host byte order
+    template <typename T>
+    void writeLittleEndian(std::ofstream& file, T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+
+        if (!isHostLittleEndian())
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        file.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+
+    template <typename T>
+    bool readLittleEndian(std::ifstream& file, T& value)
+    {
+        unsigned char bytes[sizeof(T)];
+
+        if (!file.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+        {
+            return false;
+        }
+
+        if (!isHostLittleEndian())
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+}
+
+OutputTable getOutputTableOf(const Parcel& parcel)
+{
+    OutputTable table;
+
+    table.columns = {
+        { "position", &parcel.position },
+        { "velocity", &parcel.velocity },
+        { "pressure", &parcel.pressure },
+        { "temperature", &parcel.temperature },
+        { "virtual_temperature", &parcel.temperatureVirtual },
+        { "mixing_ratio", &parcel.mixingRatio },
+        { "saturation_mixing_ratio", &parcel.mixingRatioSaturated } };
+    table.rows = parcel.getStoredSteps();
+
+    return table;
+}
+
+OutputTable getSummaryTableOf(const ParcelSummary& summary, std::vector<TrajectoryField>& values)
+{
+    const std::vector<std::pair<std::string, double>> diagnostics = {
+        { "cape", summary.cape },
+        { "cin", summary.cin },
+        { "lcl_height", summary.lclHeight },
+        { "lcl_pressure", summary.lclPressure },
+        { "lfc_height", summary.lfcHeight },
+        { "el_height", summary.elHeight },
+        { "max_velocity", summary.maxVelocity },
+        { "cloud_top_height", summary.cloudTopHeight } };
+
+    OutputTable table;
+    values.assign(diagnostics.size(), TrajectoryField());
+
+    for (size_t j = 0; j < diagnostics.size(); j++)
+    {
+        values[j][0] = diagnostics[j].second;
+        table.columns.push_back({ diagnostics[j].first, &values[j] });
+    }
+
+    table.rows = 1;
+
+    return table;
+}
+
+OutputTable getDecimatedTableOf(const TrajectoryDecimation& decimation)
+{
+    OutputTable table;
+
+    table.columns = {
+        { "time", &decimation.time },
+        { "position", &decimation.fields[0] },
+        { "velocity", &decimation.fields[1] },
+        { "pressure", &decimation.fields[2] },
+        { "temperature", &decimation.fields[3] },
+        { "virtual_temperature", &decimation.fields[4] },
+        { "mixing_ratio", &decimation.fields[5] },
+        { "saturation_mixing_ratio", &decimation.fields[6] } };
+    table.rows = decimation.rows;
+
+    return table;
+}
+
+OutputTable getResultTableOf(const Parcel& parcel, std::vector<TrajectoryField>& summaryValues, TrajectoryDecimation& decimatedTrajectory)
+{
+    if (parcel.isSummaryOnly)
+    {
+        return getSummaryTableOf(parcel.getSummary(), summaryValues);
+    }
+    else if (parcel.isDecimated)
+    {
+        decimatedTrajectory = parcel.getDecimatedTrajectory();
+        return getDecimatedTableOf(decimatedTrajectory);
+    }
+
+    return getOutputTableOf(parcel);
+}
+
+bool writeTextOutput(const std::string& fileName, const OutputTable& table)
+{
+    //values are formatted with to_chars into a reusable block that is written out once full
+    //fixed notation with 5 decimals matches std::fixed << std::setprecision(5) byte for byte
+    const size_t blockSize = 1 << 20;
+    const size_t maxValueLength = 400; //longest fixed-notation double with separator
+
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf(nullptr, 0);
+    output.open(fileName, std::ios::binary);
+
+    if (!output.is_open())
+    {
+        std::cout << "Directory ./output must exits. Please create it!\n";
+        return false;
+    }
+
+    std::vector<char> block(blockSize);
+    char* cursor = block.data();
+    char* const blockEnd = block.data() + block.size();
+
+    auto flushBlock = [&]()
+    {
+        output.write(block.data(), cursor - block.data());
+        cursor = block.data();
+    };
+
+    for (size_t j = 0; j < table.columns.size(); j++)
+    {
+        const std::string& name = table.columns[j].name;
+
+        if (static_cast<size_t>(blockEnd - cursor) < name.size() + 2)
+        {
+            flushBlock();
+        }
+
+        cursor = std::copy(name.begin(), name.end(), cursor);
+        *cursor++ = ';';
+
+        if (j + 1 < table.columns.size())
+        {
+            *cursor++ = ' ';
+        }
+    }
+    *cursor++ = '\n';
+
+    for (size_t i = 0; i < table.rows; i++)
+    {
+        for (size_t j = 0; j < table.columns.size(); j++)
+        {
+            if (static_cast<size_t>(blockEnd - cursor) < maxValueLength)
+            {
+                flushBlock();
+            }
+
+            cursor = std::to_chars(cursor, blockEnd, (*table.columns[j].values)[i], std::chars_format::fixed, 5).ptr;
+            *cursor++ = ';';
+
+            if (j + 1 < table.columns.size())
+            {
+                *cursor++ = ' ';
+            }
+        }
+
+        *cursor++ = '\n';
+    }
+
+    flushBlock();
+    output.close();
+
+    return output.good();
+}
+
+bool writeBinaryOutput(const std::string& fileName, const OutputTable& table)
+{
+    std::ofstream output(fileName, std::ios::binary);
+
+    if (!output.is_open())
+    {
+        std::cout << "Directory ./output must exits. Please create it!\n";
+        return false;
+    }
+
+    //header
+    output.write(binaryOutputMagic, sizeof(binaryOutputMagic));
+    writeLittleEndian<uint32_t>(output, binaryOutputVersion);
+    writeLittleEndian<uint32_t>(output, static_cast<uint32_t>(table.columns.size()));
+    writeLittleEndian<uint64_t>(output, table.rows);
+    writeLittleEndian<uint64_t>(output, 0);
+
+    //column descriptors
+    uint64_t columnOffset = binaryOutputHeaderSize + (binaryOutputDescriptorSize * table.columns.size());
+
+    for (const OutputColumn& column : table.columns)
+    {
+        char name[binaryOutputNameLength] = {};
+        std::strncpy(name, column.name.c_str(), binaryOutputNameLength);
+
+        output.write(name, binaryOutputNameLength);
+        writeLittleEndian<uint32_t>(output, binaryOutputFloat64);
+        writeLittleEndian<uint32_t>(output, 0);
+        writeLittleEndian<uint64_t>(output, columnOffset);
+
+        columnOffset += table.rows * sizeof(double);
+    }
+
+    //column data, written chunk by chunk straight from the trajectory fields on little-endian hosts
+    for (const OutputColumn& column : table.columns)
+    {
+        for (size_t chunkStart = 0; chunkStart < table.rows; chunkStart += TrajectoryField::chunkSize)
+        {
+            size_t chunkLength = std::min(TrajectoryField::chunkSize, table.rows - chunkStart);
+
+            if (isHostLittleEndian())
+            {
+                output.write(reinterpret_cast<const char*>(column.values->getChunk(chunkStart / TrajectoryField::chunkSize)), chunkLength * sizeof(double));
+                continue;
+            }
+
+            for (size_t i = chunkStart; i < chunkStart + chunkLength; i++)
+            {
+                writeLittleEndian<double>(output, (*column.values)[i]);
+            }
+        }
+    }
+
+    output.close();
+
+    return output.good();
+}
+
+bool readBinaryOutput(const std::string& fileName, std::vector<std::string>& names, std::vector<TrajectoryField>& columns, size_t& rows)
+{
+    std::ifstream input(fileName, std::ios::binary);
+
+    if (!input.is_open())
+    {
+        std::cout << "Cannot open " << fileName << "\n";
+        return false;
+    }
+
+    char magic[sizeof(binaryOutputMagic)];
+    uint32_t version, columnCount;
+    uint64_t rowCount, reserved;
+
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, binaryOutputMagic, sizeof(magic)) != 0)
+    {
+        std::cout << fileName << " is not a binary model output\n";
+        return false;
+    }
+
+    if (!readLittleEndian(input, version) || !readLittleEndian(input, columnCount) || !readLittleEndian(input, rowCount) || !readLittleEndian(input, reserved))
+    {
+        std::cout << fileName << " has a truncated header\n";
+        return false;
+    }
+
+    if (version != binaryOutputVersion)
+    {
+        std::cout << fileName << " has unsupported format version " << version << "\n";
+        return false;
+    }
+
+    std::vector<uint64_t> offsets(columnCount);
+    names.assign(columnCount, "");
+
+    for (uint32_t j = 0; j < columnCount; j++)
+    {
+        char name[binaryOutputNameLength];
+        uint32_t valueType, reservedField;
+
+        if (!input.read(name, binaryOutputNameLength) || !readLittleEndian(input, valueType) || !readLittleEndian(input, reservedField) || !readLittleEndian(input, offsets[j]) || valueType != binaryOutputFloat64)
+        {
+            std::cout << fileName << " has an invalid column descriptor\n";
+            return false;
+        }
+
+        names[j] = std::string(name, strnlen(name, binaryOutputNameLength));
+    }
+
+    columns.assign(columnCount, TrajectoryField());
+    rows = rowCount;
+
+    for (uint32_t j = 0; j < columnCount; j++)
+    {
+        input.seekg(offsets[j]);
+
+        for (size_t i = 0; i < rows; i++)
+        {
+            double value;
+
+            if (!readLittleEndian(input, value))
+            {
+                std::cout << fileName << " is truncated in column " << names[j] << "\n";
+                return false;
+            }
+
+            columns[j][i] = value;
+        }
+    }
+
+    return true;
+}
+
+bool outputDataFrom(const Parcel& parcel)
+{
+    //text output unless parcel.conf asks for the binary columnar format
+    std::vector<TrajectoryField> summaryValues;
+    TrajectoryDecimation decimatedTrajectory;
+    OutputTable table = getResultTableOf(parcel, summaryValues, decimatedTrajectory);
+    auto format = parcel.parcelConfiguration.find("output_format");
+
+    if (format != parcel.parcelConfiguration.end() && format->second == "binary")
+    {
+        return writeBinaryOutput(parcel.outputFileName, table);
+    }
+
+    return writeTextOutput(parcel.outputFileName, table);
+}
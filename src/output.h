@@ -0,0 +1,58 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "parcel.h"
+#include "parcel_summary.h"
+#include "trajectory_decimation.h"
+#include "trajectory_field.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//binary output (output_format=binary), all integers and values little-endian:
+//  0  char[8]   magic "PSIM1DBC"
+//  8  uint32    format version
+//  12 uint32    number of columns
+//  16 uint64    number of rows
+//  24 uint64    reserved
+//  32 column descriptors, 40 bytes each:
+//     char[24]  column name, zero padded
+//     uint32    value type (1 - float64)
+//     uint32    reserved
+//     uint64    byte offset of the column from the start of the file
+//  column data follows, every column 8-byte aligned and contiguous, so it can be read straight from an mmap
+
+struct OutputColumn
+{
+	std::string name;
+	const TrajectoryField* values;
+};
+
+struct OutputTable
+{
+	std::vector<OutputColumn> columns;
+	size_t rows;
+};
+
+const char binaryOutputMagic[8] = { 'P', 'S', 'I', 'M', '1', 'D', 'B', 'C' };
+const uint32_t binaryOutputVersion = 1;
+const uint32_t binaryOutputFloat64 = 1;
+const size_t binaryOutputHeaderSize = 32;
+const size_t binaryOutputDescriptorSize = 40;
+const size_t binaryOutputNameLength = 24;
+
+OutputTable getOutputTableOf(const Parcel& parcel);
+//single row of diagnostics (output_mode=summary), values holds the columns and has to outlive the table
+OutputTable getSummaryTableOf(const ParcelSummary& summary, std::vector<TrajectoryField>& values);
+//rows at the decimation levels (output_decimation) with a leading time column, the table points into decimation
+OutputTable getDecimatedTableOf(const TrajectoryDecimation& decimation);
+//table of the output mode the parcel was run with, summaryValues and decimatedTrajectory hold the columns that are not parcel fields
+OutputTable getResultTableOf(const Parcel& parcel, std::vector<TrajectoryField>& summaryValues, TrajectoryDecimation& decimatedTrajectory);
+
+bool writeTextOutput(const std::string& fileName, const OutputTable& table);
+bool writeBinaryOutput(const std::string& fileName, const OutputTable& table);
+bool readBinaryOutput(const std::string& fileName, std::vector<std::string>& names, std::vector<TrajectoryField>& columns, size_t& rows);
+
+bool outputDataFrom(const Parcel& parcel);
+
+#endif
@@ -0,0 +1,63 @@
+#include "profile_reader.h"
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+//packs .profile files into one profile archive, which run_mode=batch reads as batch_input
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4 || (std::string(argv[2]) != "float" && std::string(argv[2]) != "double"))
+    {
+        std::cout << "Usage: " << argv[0] << " <archive file> <float|double> <profile file or directory>...\n";
+        return -1;
+    }
+
+    //directories contribute all their .profile files in name order
+    std::vector<std::string> profileFileNames;
+
+    for (int i = 3; i < argc; i++)
+    {
+        std::error_code error;
+
+        if (!std::filesystem::is_directory(argv[i], error))
+        {
+            profileFileNames.push_back(argv[i]);
+            continue;
+        }
+
+        std::vector<std::string> directoryProfiles;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(argv[i], error))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".profile")
+            {
+                directoryProfiles.push_back(entry.path().string());
+            }
+        }
+
+        std::sort(directoryProfiles.begin(), directoryProfiles.end());
+        profileFileNames.insert(profileFileNames.end(), directoryProfiles.begin(), directoryProfiles.end());
+    }
+
+    try
+    {
+        writeProfileArchive(argv[1], profileFileNames, std::string(argv[2]) == "float");
+    }
+    catch (const std::exception& error)
+    {
+        //no partly written archive is left behind
+        std::error_code removeError;
+        std::filesystem::remove(argv[1], removeError);
+
+        std::cout << error.what() << "\n";
+        return -1;
+    }
+
+    std::cout << "Packed " << profileFileNames.size() << " profiles into " << argv[1] << "\n";
+    return 0;
+}
@@ -7,48 +7,93 @@
 #include <string>
 #include <vector>
 
-Parcel::Parcel()
+template <class Real>
+BasicParcel<Real>::BasicParcel()
 {
+    environment = nullptr;
     timeDeltaSquared = 0;
     timeDelta = 0;
     currentTimeStep = 0;
     ascentSteps = 0;
     noMoistureTreshold = 0;
+    isSummaryOnly = false;
+    isDecimated = false;
+    isFastThermodynamics = false;
 }
 
-Parcel::Parcel(const std::map<std::string, std::string>& parcelConfiguration) :
+template <class Real>
+BasicParcel<Real>::BasicParcel(const BasicEnvironment<Real>& environment, const std::map<std::string, std::string>& parcelConfiguration) :
+    environment(&environment),
     parcelConfiguration(parcelConfiguration),
     outputFileName(parcelConfiguration.at("output_filename")),
-    noMoistureTreshold(std::stod(parcelConfiguration.at("no_moisture_trsh")))
+    noMoistureTreshold(std::stod(parcelConfiguration.at("no_moisture_trsh"))),
+    isSummaryOnly(parcelConfiguration.find("output_mode") != parcelConfiguration.end() && parcelConfiguration.at("output_mode") == "summary"),
+    isDecimated(false),
+    isFastThermodynamics(parcelConfiguration.find("thermo_precision") != parcelConfiguration.end() && parcelConfiguration.at("thermo_precision") == "fast")
 {
+    //decimation only applies to trajectory output
+    if (!isSummaryOnly)
+    {
+        decimation = TrajectoryDecimation(parcelConfiguration);
+        isDecimated = decimation.mode != TrajectoryDecimation::Mode::none;
+    }
+
+    if (isSummaryOnly || isDecimated)
+    {
+        for (BasicTrajectoryField<Real>* field : { &position, &velocity, &pressure, &temperature, &temperatureVirtual, &mixingRatio, &mixingRatioSaturated })
+        {
+            field->makeRolling(summaryRollingSteps);
+        }
+    }
+
     calculateConstants();
-    setupVariableFields();
     setInitialConditionsAndLocation();
 }
 
-void Parcel::calculateConstants()
+template <class Real>
+template <class Other>
+BasicParcel<Real>::BasicParcel(const BasicParcel<Other>& other, const BasicEnvironment<Real>& environment) :
+    environment(&environment),
+    parcelConfiguration(other.parcelConfiguration),
+    outputFileName(other.outputFileName),
+    noMoistureTreshold(other.noMoistureTreshold),
+    position(other.position),
+    velocity(other.velocity),
+    pressure(other.pressure),
+    temperature(other.temperature),
+    temperatureVirtual(other.temperatureVirtual),
+    mixingRatio(other.mixingRatio),
+    mixingRatioSaturated(other.mixingRatioSaturated),
+    isSummaryOnly(other.isSummaryOnly),
+    isDecimated(other.isDecimated),
+    isFastThermodynamics(other.isFastThermodynamics),
+    currentTimeStep(other.currentTimeStep),
+    summary(other.summary),
+    decimation(other.decimation),
+    adiabatConstants(other.adiabatConstants)
 {
-    double period = std::stod(parcelConfiguration.at("period"));
-
-    timeDelta = std::stod(parcelConfiguration.at("timestep"));
-    timeDeltaSquared = timeDelta * timeDelta;
+    //timestep constants come from the configuration again instead of being rounded between the types
+    calculateConstants();
 
-    ascentSteps = static_cast<size_t>(floor((period * 3600) / timeDelta) + 1); //including step zero
+    currentLocation.position = other.currentLocation.position;
+    currentLocation.sector = other.currentLocation.sector;
 }
 
-void Parcel::setupVariableFields()
+template <class Real>
+void BasicParcel<Real>::calculateConstants()
 {
-    std::vector<double> holder(ascentSteps, -999.0);
-    position = holder;
-    velocity = holder;
-    pressure = holder;
-    temperature = holder;
-    temperatureVirtual = holder;
-    mixingRatio = holder;
-    mixingRatioSaturated = holder;
+    double period = std::stod(parcelConfiguration.at("period"));
+    double timestep = std::stod(parcelConfiguration.at("timestep"));
+
+    timeDelta = timestep;
+    timeDeltaSquared = timeDelta * timeDelta;
+
+    //step count from the configured values, timeDelta may be rounded to float
+    ascentSteps = static_cast<size_t>(floor((period * 3600) / timestep) + 1); //including step zero
 }
 
-void Parcel::setInitialConditionsAndLocation()
+template <class Real>
+void BasicParcel<Real>::setInitialConditionsAndLocation()
 {
     //write initial conditions into parcel and convert to SI units
 
@@ -60,42 +105,78 @@ void Parcel::setInitialConditionsAndLocation()
     currentTimeStep = 0;
 
     currentLocation.position = position[0];
-    currentLocation.updateSector();
+    currentLocation.updateSector(*environment);
 
     //intermediate variables initial conditions
-    pressure[0] = Environment::getPressureAtLocation(currentLocation);
+    pressure[0] = environment->getPressureAtLocation(currentLocation);
 
-    mixingRatio[0] = calcMixingRatio((std::stod(parcelConfiguration.at("init_dewpoint")) + 273.15), pressure[0]);
+    mixingRatio[0] = calcMixingRatio(Real(std::stod(parcelConfiguration.at("init_dewpoint")) + 273.15), pressure[0]);
     temperatureVirtual[0] = calcVirtualTemperature(temperature[0], mixingRatio[0]);
     mixingRatioSaturated[0] = calcMixingRatio(temperature[0], pressure[0]);
 }
 
-void Parcel::updateCurrentDynamicsAndPressure()
+template <class Real>
+void BasicParcel<Real>::updateCurrentDynamicsAndPressure()
 {
+    //previous timestep is complete once the dynamics move on, its location is still the current one
+    if (isSummaryOnly)
+    {
+        addStepTo(summary, currentTimeStep - 1, currentLocation);
+    }
+    else if (isDecimated)
+    {
+        addStepTo(decimation, currentTimeStep - 1);
+    }
+
     currentLocation.position = position[currentTimeStep];
-    currentLocation.updateSector();
-    pressure[currentTimeStep] = Environment::getPressureAtLocation(currentLocation); //pressure of parcel always equalises with atmosphere
+    currentLocation.updateSector(*environment);
+    pressure[currentTimeStep] = environment->getPressureAtLocation(currentLocation); //pressure of parcel always equalises with atmosphere
 }
 
-void Parcel::updateCurrentThermodynamicsAdiabatically(double lambda, double gamma)
+template <class Real>
+void BasicParcel<Real>::updateCurrentThermodynamicsAdiabatically(Real lambda, Real gamma)
 {
-    temperature[currentTimeStep] = calcTemperatureInAdiabat(pressure[currentTimeStep], gamma, lambda);
+    temperature[currentTimeStep] = getTemperatureInAdiabat(pressure[currentTimeStep], gamma, lambda);
     mixingRatio[currentTimeStep] = mixingRatio[currentTimeStep - 1]; //mixing ratio is conservative during adiabatic ascent
-    mixingRatioSaturated[currentTimeStep] = calcMixingRatio(temperature[currentTimeStep], pressure[currentTimeStep]);
+    mixingRatioSaturated[currentTimeStep] = getMixingRatio(temperature[currentTimeStep], pressure[currentTimeStep]);
     temperatureVirtual[currentTimeStep] = calcVirtualTemperature(temperature[currentTimeStep], mixingRatio[currentTimeStep]);
 }
 
-void Parcel::updateCurrentThermodynamicsPseudoadiabatically()
+template <class Real>
+void BasicParcel<Real>::updateCurrentThermodynamicsPseudoadiabatically()
 {
-    mixingRatioSaturated[currentTimeStep] = calcMixingRatio(temperature[currentTimeStep], pressure[currentTimeStep]);
+    mixingRatioSaturated[currentTimeStep] = getMixingRatio(temperature[currentTimeStep], pressure[currentTimeStep]);
     mixingRatio[currentTimeStep] = mixingRatioSaturated[currentTimeStep];
     temperatureVirtual[currentTimeStep] = calcVirtualTemperature(temperature[currentTimeStep], mixingRatio[currentTimeStep]);
 }
 
-Parcel::Slice Parcel::getSlice(size_t stepsForwardFromCurrent)
+template <class Real>
+Real BasicParcel<Real>::getTemperatureInAdiabat(Real pressure, Real gamma, Real lambda)
+{
+    if (isFastThermodynamics)
+    {
+        return calcTemperatureInAdiabatFast(pressure, gamma, lambda, adiabatConstants);
+    }
+
+    return calcTemperatureInAdiabat(pressure, gamma, lambda);
+}
+
+template <class Real>
+Real BasicParcel<Real>::getMixingRatio(Real temperature, Real pressure) const
+{
+    if (isFastThermodynamics)
+    {
+        return calcMixingRatioFast(temperature, pressure);
+    }
+
+    return calcMixingRatio(temperature, pressure);
+}
+
+template <class Real>
+typename BasicParcel<Real>::Slice BasicParcel<Real>::getSlice(size_t stepsForwardFromCurrent)
 {
     size_t timestep = currentTimeStep + stepsForwardFromCurrent;
-    Parcel::Slice slice;
+    Slice slice;
 
     slice.position = position[timestep];
     slice.pressure = pressure[timestep];
@@ -105,4 +186,55 @@ Parcel::Slice Parcel::getSlice(size_t stepsForwardFromCurrent)
     slice.temperatureVirtual = temperatureVirtual[timestep];
 
     return slice;
-}
\ No newline at end of file
+}
+
+template <class Real>
+size_t BasicParcel<Real>::getStoredSteps() const
+{
+    //number of simulated timesteps including step zero
+    return currentTimeStep + 1;
+}
+
+template <class Real>
+ParcelSummary BasicParcel<Real>::getSummary() const
+{
+    //diagnostics including the last simulated timestep
+    ParcelSummary completeSummary = summary;
+    addStepTo(completeSummary, currentTimeStep, currentLocation);
+
+    return completeSummary;
+}
+
+template <class Real>
+TrajectoryDecimation BasicParcel<Real>::getDecimatedTrajectory() const
+{
+    //rows including the last simulated timestep
+    TrajectoryDecimation completeDecimation = decimation;
+    addStepTo(completeDecimation, currentTimeStep);
+
+    return completeDecimation;
+}
+
+template <class Real>
+void BasicParcel<Real>::addStepTo(ParcelSummary& targetSummary, size_t timestep, const typename BasicEnvironment<Real>::Location& location) const
+{
+    Real bouyancy = calcBouyancyForce(temperatureVirtual[timestep], environment->getVirtualTemperatureAtLocation(location));
+    bool isSaturated = mixingRatio[timestep] >= mixingRatioSaturated[timestep];
+
+    targetSummary.addStep(position[timestep], velocity[timestep], pressure[timestep], bouyancy, isSaturated);
+}
+
+template <class Real>
+void BasicParcel<Real>::addStepTo(TrajectoryDecimation& targetDecimation, size_t timestep) const
+{
+    const double values[TrajectoryDecimation::fieldCount] = { position[timestep], velocity[timestep], pressure[timestep], temperature[timestep],
+        temperatureVirtual[timestep], mixingRatio[timestep], mixingRatioSaturated[timestep] };
+
+    targetDecimation.addStep(timestep * static_cast<double>(timeDelta), values);
+}
+
+template class BasicParcel<float>;
+template class BasicParcel<double>;
+
+template BasicParcel<float>::BasicParcel(const BasicParcel<double>& other, const BasicEnvironment<float>& environment);
+template BasicParcel<double>::BasicParcel(const BasicParcel<float>& other, const BasicEnvironment<double>& environment);
@@ -3,48 +3,89 @@
 
 #include "thermodynamic_calc.h"
 #include "environment.h"
+#include "parcel_summary.h"
+#include "trajectory_decimation.h"
+#include "trajectory_field.h"
 #include <map>
 #include <string>
 
-class Parcel
+//parcel state at one timestep
+template <class Real>
+struct ParcelSlice
+{
+	Real position = 0;
+	Real velocity = 0;
+	Real pressure = 0;
+	Real temperature = 0;
+	Real temperatureVirtual = 0;
+	Real mixingRatio = 0;
+	Real mixingRatioSaturated = 0;
+
+	ParcelSlice() {};
+};
+
+//trajectory stored and stepped in Real, float or double (floating_point in parcel.conf, see createDynamicScheme)
+//output and diagnostics are always double
+template <class Real>
+class BasicParcel
 {
 private:
 	void calculateConstants();
-	void setupVariableFields(); 
 	void setInitialConditionsAndLocation();
 
 public:
-	struct Slice
-	{
-		double position = 0;
-		double velocity = 0;
-		double pressure = 0;
-		double temperature = 0;
-		double temperatureVirtual = 0;
-		double mixingRatio = 0;
-		double mixingRatioSaturated = 0;
-
-		Slice() {};
-	};
+	using Slice = ParcelSlice<Real>;
 
+	const BasicEnvironment<Real>* environment;
 	std::map<std::string, std::string> parcelConfiguration;
 	std::string outputFileName;
-	double noMoistureTreshold;
+	Real noMoistureTreshold;
 
-	std::vector<double> position, velocity, pressure, temperature, temperatureVirtual, mixingRatio, mixingRatioSaturated;
+	//fields grow with the simulation, valid values are those up to currentTimeStep
+	//with output_mode=summary or output_decimation they only hold the last few timesteps and the output is accumulated instead
+	BasicTrajectoryField<Real> position, velocity, pressure, temperature, temperatureVirtual, mixingRatio, mixingRatioSaturated;
+	bool isSummaryOnly;
+	bool isDecimated;
+	bool isFastThermodynamics; //thermo_precision=fast
 
 	size_t ascentSteps, currentTimeStep;
-	double timeDelta, timeDeltaSquared;
-	Environment::Location currentLocation;
+	Real timeDelta, timeDeltaSquared;
+	typename BasicEnvironment<Real>::Location currentLocation;
 
-	Parcel();
-	Parcel(const std::map<std::string, std::string>& parcelConfiguration);
+	BasicParcel();
+	BasicParcel(const BasicEnvironment<Real>& environment, const std::map<std::string, std::string>& parcelConfiguration);
+	//the same parcel and trajectory in another floating-point type, located in an environment of that type
+	template <class Other>
+	BasicParcel(const BasicParcel<Other>& other, const BasicEnvironment<Real>& environment);
 
 	void updateCurrentDynamicsAndPressure();
-	void updateCurrentThermodynamicsAdiabatically(double lambda, double gamma);
+	void updateCurrentThermodynamicsAdiabatically(Real lambda, Real gamma);
 	void updateCurrentThermodynamicsPseudoadiabatically();
 
-	Parcel::Slice getSlice(size_t stepsBackFromCurrent);
+	//thermodynamic functions in the precision selected by thermo_precision, used by the dynamic schemes as well
+	Real getTemperatureInAdiabat(Real pressure, Real gamma, Real lambda);
+	Real getMixingRatio(Real temperature, Real pressure) const;
+
+	Slice getSlice(size_t stepsBackFromCurrent);
+	size_t getStoredSteps() const;
+	ParcelSummary getSummary() const;
+	TrajectoryDecimation getDecimatedTrajectory() const;
+
+private:
+	template <class Other>
+	friend class BasicParcel;
+
+	//timesteps kept in summary and decimated mode, enough for the schemes looking one step back and one ahead
+	static const size_t summaryRollingSteps = 4;
+
+	ParcelSummary summary;
+	TrajectoryDecimation decimation;
+	AdiabatConstants adiabatConstants;
+
+	void addStepTo(ParcelSummary& targetSummary, size_t timestep, const typename BasicEnvironment<Real>::Location& location) const;
+	void addStepTo(TrajectoryDecimation& targetDecimation, size_t timestep) const;
 };
 
+using Parcel = BasicParcel<double>;
+
 #endif
@@ -0,0 +1,98 @@
+#include "parcel_summary.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ParcelSummary::ParcelSummary() :
+    cape(0.0),
+    cin(0.0),
+    lclHeight(std::numeric_limits<double>::quiet_NaN()),
+    lclPressure(std::numeric_limits<double>::quiet_NaN()),
+    lfcHeight(std::numeric_limits<double>::quiet_NaN()),
+    elHeight(std::numeric_limits<double>::quiet_NaN()),
+    maxVelocity(-std::numeric_limits<double>::infinity()),
+    cloudTopHeight(std::numeric_limits<double>::quiet_NaN()),
+    steps(0),
+    isFirstAscent(true),
+    previousPosition(0.0),
+    previousBouyancy(0.0),
+    highestPosition(-std::numeric_limits<double>::infinity())
+{
+}
+
+void ParcelSummary::addStep(double position, double velocity, double pressure, double bouyancy, bool isSaturated)
+{
+    maxVelocity = std::max(maxVelocity, velocity);
+    highestPosition = std::max(highestPosition, position);
+
+    //the parcel is saturated for the first time
+    if (isSaturated && std::isnan(lclHeight))
+    {
+        lclHeight = position;
+        lclPressure = pressure;
+
+        if (bouyancy > 0.0)
+        {
+            lfcHeight = position;
+        }
+    }
+
+    if (!std::isnan(lclHeight))
+    {
+        cloudTopHeight = highestPosition;
+    }
+
+    if (steps > 0 && isFirstAscent)
+    {
+        if (position < previousPosition)
+        {
+            isFirstAscent = false;
+        }
+        else
+        {
+            addLayer(previousPosition, position, previousBouyancy, bouyancy);
+        }
+    }
+
+    previousPosition = position;
+    previousBouyancy = bouyancy;
+    steps++;
+}
+
+void ParcelSummary::addLayer(double lowerPosition, double upperPosition, double lowerBouyancy, double upperBouyancy)
+{
+    //trapezoidal area, split where the buoyancy changes sign
+    if ((lowerBouyancy > 0.0) == (upperBouyancy > 0.0))
+    {
+        addBouyancyArea(0.5 * (lowerBouyancy + upperBouyancy) * (upperPosition - lowerPosition));
+        return;
+    }
+
+    double crossingPosition = lowerPosition + ((upperPosition - lowerPosition) * lowerBouyancy / (lowerBouyancy - upperBouyancy));
+
+    addBouyancyArea(0.5 * lowerBouyancy * (crossingPosition - lowerPosition));
+
+    if (upperBouyancy > 0.0 && !std::isnan(lclHeight) && std::isnan(lfcHeight))
+    {
+        lfcHeight = std::max(crossingPosition, lclHeight);
+    }
+    else if (upperBouyancy <= 0.0 && !std::isnan(lfcHeight))
+    {
+        elHeight = crossingPosition;
+    }
+
+    addBouyancyArea(0.5 * upperBouyancy * (upperPosition - crossingPosition));
+}
+
+void ParcelSummary::addBouyancyArea(double area)
+{
+    //positive area counts once the parcel is above the LFC, negative area only below it
+    if (!std::isnan(lfcHeight))
+    {
+        cape += std::max(area, 0.0);
+    }
+    else
+    {
+        cin += std::min(area, 0.0);
+    }
+}
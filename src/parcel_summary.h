@@ -0,0 +1,33 @@
+#ifndef PARCEL_SUMMARY_H
+#define PARCEL_SUMMARY_H
+
+#include <cstddef>
+
+//diagnostics of one parcel accumulated step by step, so the trajectory itself does not have to be kept
+//buoyancy areas are integrated over height along the first ascent of the parcel
+class ParcelSummary
+{
+public:
+	double cape; //positive buoyancy area above the LFC, J/kg
+	double cin; //negative buoyancy area below the LFC, J/kg (zero or negative)
+	double lclHeight, lclPressure; //first saturated timestep, m and Pa
+	double lfcHeight; //height where the saturated parcel becomes positively buoyant, m
+	double elHeight; //height where the parcel loses buoyancy above the LFC, m
+	double maxVelocity; //m/s
+	double cloudTopHeight; //highest point reached above the LCL, m
+
+	//levels that were not reached are NaN
+	ParcelSummary();
+
+	void addStep(double position, double velocity, double pressure, double bouyancy, bool isSaturated);
+
+private:
+	size_t steps;
+	bool isFirstAscent;
+	double previousPosition, previousBouyancy, highestPosition;
+
+	void addLayer(double lowerPosition, double upperPosition, double lowerBouyancy, double upperBouyancy);
+	void addBouyancyArea(double area);
+};
+
+#endif
@@ -0,0 +1,461 @@
+#include "profile_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& fileName) :
+    data(nullptr),
+    size(0)
+{
+    int descriptor = open(fileName.c_str(), O_RDONLY);
+
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("cannot open profile file " + fileName + ": " + std::strerror(errno));
+    }
+
+    struct stat fileStatus;
+
+    if (fstat(descriptor, &fileStatus) != 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("cannot read profile file " + fileName + ": " + std::strerror(errno));
+    }
+
+    size = static_cast<size_t>(fileStatus.st_size);
+
+    if (size > 0)
+    {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            close(descriptor);
+            throw std::runtime_error("cannot map profile file " + fileName + ": " + std::strerror(errno));
+        }
+
+        data = static_cast<const char*>(mapping);
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+
+    close(descriptor);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+namespace
+{
+    const char* const columnNames[4] = { "HGHT", "PRES", "TEMP", "DWPT" };
+
+    bool isBlank(char character)
+    {
+        return character == ' ' || character == '\t' || character == '\r';
+    }
+
+    const char* skipBlanks(const char* position, const char* lineEnd)
+    {
+        while (position < lineEnd && isBlank(*position))
+        {
+            position++;
+        }
+
+        return position;
+    }
+
+    //shortest text that reads back as the same value
+    std::string formatValue(double value)
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+        return std::string(buffer, result.ptr);
+    }
+
+    std::runtime_error makeLineError(const std::string& fileName, size_t lineNumber, const std::string& message)
+    {
+        return std::runtime_error(fileName + ":" + std::to_string(lineNumber) + ": " + message);
+    }
+
+    bool isHostLittleEndian()
+    {
+        const uint16_t probe = 1;
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+
+        return firstByte == 1;
+    }
+
+    //value stored as little-endian bytes at any alignment
+    template <typename T>
+    T readLittleEndian(const char* position)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, position, sizeof(T));
+
+        if (!isHostLittleEndian())
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+
+        return value;
+    }
+
+    template <typename T>
+    void writeLittleEndian(std::ofstream& file, T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+
+        if (!isHostLittleEndian())
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        file.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+
+    //one field of a column, copied in a single block when the archive holds doubles in host byte order
+    template <typename T>
+    void readArchiveField(const char* position, size_t levels, std::vector<double>& field)
+    {
+        field.resize(levels);
+
+        if (sizeof(T) == sizeof(double) && isHostLittleEndian())
+        {
+            std::memcpy(field.data(), position, levels * sizeof(double));
+            return;
+        }
+
+        for (size_t i = 0; i < levels; i++)
+        {
+            field[i] = readLittleEndian<T>(position + (i * sizeof(T)));
+        }
+    }
+}
+
+void readProfileFile(const std::string& fileName, std::vector<double>& height, std::vector<double>& pressure, std::vector<double>& temperature, std::vector<double>& dewpoint)
+{
+    MappedFile file(fileName);
+
+    const char* position = file.data;
+    const char* fileEnd = file.data + file.size;
+    size_t lineNumber = 0;
+
+    std::vector<double>* columns[4] = { &height, &pressure, &temperature, &dewpoint };
+
+    for (std::vector<double>* column : columns)
+    {
+        column->clear();
+        column->reserve(file.size / 16); //shortest realistic level line
+    }
+
+    while (position < fileEnd)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', fileEnd - position));
+        lineEnd = lineEnd != nullptr ? lineEnd : fileEnd;
+        lineNumber++;
+
+        //first two lines hold column names and units
+        if (lineNumber <= 2 || skipBlanks(position, lineEnd) == lineEnd)
+        {
+            position = lineEnd + 1;
+            continue;
+        }
+
+        for (size_t column = 0; column < 4; column++)
+        {
+            position = skipBlanks(position, lineEnd);
+
+            if (position < lineEnd && *position == '+')
+            {
+                position++;
+            }
+
+            double value;
+            std::from_chars_result result = std::from_chars(position, lineEnd, value);
+
+            if (result.ec != std::errc())
+            {
+                throw makeLineError(fileName, lineNumber, std::string("expected a number in column ") + columnNames[column]);
+            }
+
+            position = skipBlanks(result.ptr, lineEnd);
+
+            //separator after the last column is optional
+            if (position < lineEnd && *position == ';')
+            {
+                position++;
+            }
+            else if (column < 3)
+            {
+                throw makeLineError(fileName, lineNumber, std::string("expected ';' after column ") + columnNames[column]);
+            }
+
+            columns[column]->push_back(value);
+        }
+
+        if (skipBlanks(position, lineEnd) != lineEnd)
+        {
+            throw makeLineError(fileName, lineNumber, "unexpected text after column DWPT");
+        }
+
+        size_t levels = height.size();
+
+        if (levels > 1 && height[levels - 1] < height[levels - 2])
+        {
+            throw makeLineError(fileName, lineNumber, "height " + formatValue(height[levels - 1]) + " is below the previous level " + formatValue(height[levels - 2]));
+        }
+
+        position = lineEnd + 1;
+    }
+
+    if (height.size() < 2)
+    {
+        throw std::runtime_error(fileName + ": profile needs at least two levels");
+    }
+}
+
+ProfileArchive::ProfileArchive(const std::string& fileName) :
+    fileName(fileName),
+    file(fileName),
+    valueType(0)
+{
+    if (file.size < profileArchiveHeaderSize || std::memcmp(file.data, profileArchiveMagic, sizeof(profileArchiveMagic)) != 0)
+    {
+        throw std::runtime_error(fileName + " is not a profile archive");
+    }
+
+    uint32_t version = readLittleEndian<uint32_t>(file.data + 8);
+    valueType = readLittleEndian<uint32_t>(file.data + 12);
+    uint64_t columnCount = readLittleEndian<uint64_t>(file.data + 16);
+
+    if (version != profileArchiveVersion)
+    {
+        throw std::runtime_error(fileName + " has unsupported format version " + std::to_string(version));
+    }
+
+    if (valueType != profileArchiveFloat64 && valueType != profileArchiveFloat32)
+    {
+        throw std::runtime_error(fileName + " has unsupported value type " + std::to_string(valueType));
+    }
+
+    if (columnCount > (file.size - profileArchiveHeaderSize) / profileArchiveDescriptorSize)
+    {
+        throw std::runtime_error(fileName + " has a truncated column index");
+    }
+
+    //the whole index is checked here, so columns can be read later without bounds checks
+    size_t valueSize = valueType == profileArchiveFloat64 ? sizeof(double) : sizeof(float);
+    columns.resize(columnCount);
+
+    for (size_t j = 0; j < columnCount; j++)
+    {
+        const char* descriptor = file.data + profileArchiveHeaderSize + (j * profileArchiveDescriptorSize);
+        Column& column = columns[j];
+
+        column.station = std::string(descriptor, strnlen(descriptor, profileArchiveNameLength));
+        column.time = std::string(descriptor + profileArchiveNameLength, strnlen(descriptor + profileArchiveNameLength, profileArchiveNameLength));
+        column.offset = readLittleEndian<uint64_t>(descriptor + (2 * profileArchiveNameLength));
+        column.levels = readLittleEndian<uint64_t>(descriptor + (2 * profileArchiveNameLength) + 8);
+
+        if (column.levels < 2)
+        {
+            throw std::runtime_error(fileName + ": column " + getColumnName(j) + " needs at least two levels");
+        }
+
+        if (column.offset > file.size || column.levels > (file.size - column.offset) / (4 * valueSize))
+        {
+            throw std::runtime_error(fileName + ": column " + getColumnName(j) + " lies outside of the file");
+        }
+    }
+}
+
+size_t ProfileArchive::size() const
+{
+    return columns.size();
+}
+
+const ProfileArchive::Column& ProfileArchive::getColumn(size_t index) const
+{
+    return columns.at(index);
+}
+
+std::string ProfileArchive::getColumnName(size_t index) const
+{
+    const Column& column = columns.at(index);
+
+    return column.time.empty() ? column.station : column.station + "_" + column.time;
+}
+
+void ProfileArchive::readColumn(size_t index, std::vector<double>& height, std::vector<double>& pressure, std::vector<double>& temperature, std::vector<double>& dewpoint) const
+{
+    const Column& column = columns.at(index);
+    std::vector<double>* fields[4] = { &height, &pressure, &temperature, &dewpoint };
+
+    for (size_t field = 0; field < 4; field++)
+    {
+        if (valueType == profileArchiveFloat64)
+        {
+            readArchiveField<double>(file.data + column.offset + (field * column.levels * sizeof(double)), column.levels, *fields[field]);
+        }
+        else
+        {
+            readArchiveField<float>(file.data + column.offset + (field * column.levels * sizeof(float)), column.levels, *fields[field]);
+        }
+    }
+
+    for (size_t i = 1; i < column.levels; i++)
+    {
+        if (!(height[i] >= height[i - 1]))
+        {
+            throw std::runtime_error(fileName + ": column " + getColumnName(index) + ": height " + formatValue(height[i]) + " is below the previous level " + formatValue(height[i - 1]));
+        }
+    }
+}
+
+bool ProfileArchive::isProfileArchive(const std::string& fileName)
+{
+    std::ifstream input(fileName, std::ios::binary);
+    char magic[sizeof(profileArchiveMagic)];
+
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, profileArchiveMagic, sizeof(magic)) == 0;
+}
+
+void writeProfileArchive(const std::string& archiveFileName, const std::vector<std::string>& profileFileNames, bool isSinglePrecision)
+{
+    std::ofstream output(archiveFileName, std::ios::binary);
+
+    if (!output.is_open())
+    {
+        throw std::runtime_error("cannot create profile archive " + archiveFileName);
+    }
+
+    //header, the column index is left empty until every column has been written
+    output.write(profileArchiveMagic, sizeof(profileArchiveMagic));
+    writeLittleEndian<uint32_t>(output, profileArchiveVersion);
+    writeLittleEndian<uint32_t>(output, isSinglePrecision ? profileArchiveFloat32 : profileArchiveFloat64);
+    writeLittleEndian<uint64_t>(output, profileFileNames.size());
+    writeLittleEndian<uint64_t>(output, 0);
+
+    std::vector<char> emptyIndex(profileArchiveDescriptorSize * profileFileNames.size(), 0);
+    output.write(emptyIndex.data(), emptyIndex.size());
+
+    //column data, one profile in memory at a time
+    size_t valueSize = isSinglePrecision ? sizeof(float) : sizeof(double);
+    uint64_t columnOffset = profileArchiveHeaderSize + emptyIndex.size();
+    std::vector<double> height, pressure, temperature, dewpoint;
+    std::vector<ProfileArchive::Column> columns(profileFileNames.size());
+    std::set<std::string> columnNames;
+
+    for (size_t j = 0; j < profileFileNames.size(); j++)
+    {
+        readProfileFile(profileFileNames[j], height, pressure, temperature, dewpoint);
+
+        //station is the part of the name before the first '_', time the rest
+        std::string name = std::filesystem::path(profileFileNames[j]).stem().string();
+        size_t separator = name.find('_');
+        columns[j].station = name.substr(0, separator);
+        columns[j].time = separator != std::string::npos ? name.substr(separator + 1) : "";
+        columns[j].offset = columnOffset;
+        columns[j].levels = height.size();
+
+        if (columns[j].station.size() > profileArchiveNameLength || columns[j].time.size() > profileArchiveNameLength)
+        {
+            throw std::runtime_error(profileFileNames[j] + ": station and time have to fit in " + std::to_string(profileArchiveNameLength) + " characters each");
+        }
+
+        //batch outputs are named after the columns
+        if (!columnNames.insert(name).second)
+        {
+            throw std::runtime_error(profileFileNames[j] + ": another profile named " + name + " is already in the archive");
+        }
+
+        for (const std::vector<double>* field : { &height, &pressure, &temperature, &dewpoint })
+        {
+            //whole field at once on little-endian hosts
+            if (isSinglePrecision)
+            {
+                std::vector<float> singleField(field->begin(), field->end());
+
+                if (isHostLittleEndian())
+                {
+                    output.write(reinterpret_cast<const char*>(singleField.data()), singleField.size() * sizeof(float));
+                    continue;
+                }
+
+                for (float value : singleField)
+                {
+                    writeLittleEndian<float>(output, value);
+                }
+            }
+            else
+            {
+                if (isHostLittleEndian())
+                {
+                    output.write(reinterpret_cast<const char*>(field->data()), field->size() * sizeof(double));
+                    continue;
+                }
+
+                for (double value : *field)
+                {
+                    writeLittleEndian<double>(output, value);
+                }
+            }
+        }
+
+        uint64_t columnSize = 4 * height.size() * valueSize;
+        uint64_t padding = (8 - (columnSize % 8)) % 8;
+
+        for (uint64_t i = 0; i < padding; i++)
+        {
+            output.put('\0');
+        }
+
+        columnOffset += columnSize + padding;
+    }
+
+    //column descriptors
+    output.seekp(profileArchiveHeaderSize);
+
+    for (const ProfileArchive::Column& column : columns)
+    {
+        char station[profileArchiveNameLength] = {};
+        char time[profileArchiveNameLength] = {};
+        std::memcpy(station, column.station.data(), column.station.size());
+        std::memcpy(time, column.time.data(), column.time.size());
+
+        output.write(station, profileArchiveNameLength);
+        output.write(time, profileArchiveNameLength);
+        writeLittleEndian<uint64_t>(output, column.offset);
+        writeLittleEndian<uint64_t>(output, column.levels);
+    }
+
+    output.close();
+
+    if (!output.good())
+    {
+        throw std::runtime_error("cannot write profile archive " + archiveFileName);
+    }
+}
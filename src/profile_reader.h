@@ -0,0 +1,83 @@
+#ifndef PROFILE_READER_H
+#define PROFILE_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//read-only mapping of a whole file, released with the object
+//throws std::runtime_error when the file cannot be opened or mapped
+class MappedFile
+{
+public:
+	const char* data;
+	size_t size;
+
+	MappedFile(const std::string& fileName);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
+
+//reads the HGHT;PRES;TEMP;DWPT columns of a sounding profile (two header lines, then one level per line)
+//the file is memory-mapped and parsed in place; heights must not decrease (repeated levels are allowed)
+//throws std::runtime_error naming the file and line of the first problem
+void readProfileFile(const std::string& fileName, std::vector<double>& height, std::vector<double>& pressure, std::vector<double>& temperature, std::vector<double>& dewpoint);
+
+//packed archive of many profiles (packer.exe), all integers and values little-endian:
+//  0  char[8]   magic "PSIM1DPA"
+//  8  uint32    format version
+//  12 uint32    value type (1 - float64, 2 - float32)
+//  16 uint64    number of columns
+//  24 uint64    reserved
+//  32 column descriptors, 64 bytes each:
+//     char[24]  station, zero padded
+//     char[24]  time, zero padded
+//     uint64    byte offset of the column data from the start of the file
+//     uint64    number of levels
+//  column data follows, every column 8-byte aligned: all heights, then all pressures, temperatures and dewpoints, in the units of .profile files
+
+const char profileArchiveMagic[8] = { 'P', 'S', 'I', 'M', '1', 'D', 'P', 'A' };
+const uint32_t profileArchiveVersion = 1;
+const uint32_t profileArchiveFloat64 = 1;
+const uint32_t profileArchiveFloat32 = 2;
+const size_t profileArchiveHeaderSize = 32;
+const size_t profileArchiveDescriptorSize = 64;
+const size_t profileArchiveNameLength = 24;
+
+//the archive stays mapped for the lifetime of the object and is shared read-only by all threads reading its columns
+class ProfileArchive
+{
+public:
+	struct Column
+	{
+		std::string station, time;
+		uint64_t offset;
+		size_t levels;
+	};
+
+	//throws std::runtime_error when the file is not a complete archive
+	ProfileArchive(const std::string& fileName);
+
+	size_t size() const;
+	const Column& getColumn(size_t index) const;
+	//station and time joined as in the profile file name the column was packed from
+	std::string getColumnName(size_t index) const;
+	//levels of one column converted to double straight from the mapping, same checks as readProfileFile
+	void readColumn(size_t index, std::vector<double>& height, std::vector<double>& pressure, std::vector<double>& temperature, std::vector<double>& dewpoint) const;
+
+	static bool isProfileArchive(const std::string& fileName);
+
+private:
+	std::string fileName;
+	MappedFile file;
+	uint32_t valueType;
+	std::vector<Column> columns;
+};
+
+//packs the profiles into one archive, station and time are taken from names like 12374_20170801_12z.profile
+//throws std::runtime_error when a profile cannot be read or the archive cannot be written
+void writeProfileArchive(const std::string& archiveFileName, const std::vector<std::string>& profileFileNames, bool isSinglePrecision);
+
+#endif
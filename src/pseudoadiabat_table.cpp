@@ -0,0 +1,203 @@
+#include "thermodynamic_calc.h"
+#include "parcel.h"
+#include "pseudoadiabatic_scheme.h"
+#include "pseudoadiabat_table.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const char tableCacheMagic[8] = { 'P', 'S', 'I', 'M', '1', 'D', 'P', 'T' };
+}
+
+const PseudoadiabatTable& PseudoadiabatTable::getInstance(const std::string& cacheFileName)
+{
+    //one table per cache file, so runs naming different files each read and write their own
+    static std::mutex tablesMutex;
+    static std::map<std::string, std::unique_ptr<const PseudoadiabatTable>> tables;
+
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    std::unique_ptr<const PseudoadiabatTable>& table = tables[cacheFileName];
+
+    if (table == nullptr)
+    {
+        std::unique_ptr<PseudoadiabatTable> newTable = std::make_unique<PseudoadiabatTable>();
+
+        if (cacheFileName.empty() || !newTable->loadFrom(cacheFileName))
+        {
+            newTable->build();
+
+            if (!cacheFileName.empty())
+            {
+                newTable->saveTo(cacheFileName);
+            }
+        }
+
+        table = std::move(newTable);
+    }
+
+    return *table;
+}
+
+PseudoadiabatTable::PseudoadiabatTable()
+{
+}
+
+void PseudoadiabatTable::build()
+{
+    //integrate every curve from 1000 hPa in both directions, with substeps finer than the table spacing
+    const size_t substeps = 4;
+    const double referencePressure = 100000.0;
+    const size_t referenceLevel = static_cast<size_t>((referencePressure - firstPressure) / pressureDelta);
+
+    RungeKuttaPseudoadiabat integrator;
+    values.assign(wetBulbThetaCount * pressureCount, 0.0);
+
+    for (size_t curve = 0; curve < wetBulbThetaCount; curve++)
+    {
+        double* curveValues = values.data() + (curve * pressureCount);
+        curveValues[referenceLevel] = firstWetBulbTheta + (curve * wetBulbThetaDelta);
+
+        for (int direction : { -1, 1 })
+        {
+            Parcel::Slice slice;
+            slice.pressure = referencePressure;
+            slice.temperature = curveValues[referenceLevel];
+
+            double substepPressure = direction * (pressureDelta / substeps);
+
+            for (size_t level = referenceLevel + direction; level < pressureCount; level += direction)
+            {
+                for (size_t i = 0; i < substeps; i++)
+                {
+                    slice.mixingRatioSaturated = calcMixingRatio(slice.temperature, slice.pressure);
+                    slice.mixingRatio = slice.mixingRatioSaturated;
+                    slice.temperature = integrator.calculateCurrentPseudoadiabaticTemperature(slice, substepPressure, 0.0);
+                    slice.pressure += substepPressure;
+                }
+
+                //avoid drifting pressure from repeated additions
+                slice.pressure = firstPressure + (level * pressureDelta);
+                curveValues[level] = slice.temperature;
+            }
+        }
+    }
+}
+
+double PseudoadiabatTable::getCurveTemperature(size_t curve, double pressure) const
+{
+    //linear interpolation along one curve, extrapolating beyond the pressure range
+    double position = (pressure - firstPressure) / pressureDelta;
+    size_t level = static_cast<size_t>(std::min(std::max(position, 0.0), static_cast<double>(pressureCount - 2)));
+    double fraction = position - level;
+
+    const double* curveValues = values.data() + (curve * pressureCount);
+
+    return curveValues[level] + (fraction * (curveValues[level + 1] - curveValues[level]));
+}
+
+double PseudoadiabatTable::getTemperature(double wetBulbTheta, double pressure) const
+{
+    //bilinear interpolation, extrapolating beyond the grid
+    double position = (wetBulbTheta - firstWetBulbTheta) / wetBulbThetaDelta;
+    size_t curve = static_cast<size_t>(std::min(std::max(position, 0.0), static_cast<double>(wetBulbThetaCount - 2)));
+    double fraction = position - curve;
+
+    double lowerTemperature = getCurveTemperature(curve, pressure);
+    double upperTemperature = getCurveTemperature(curve + 1, pressure);
+
+    return lowerTemperature + (fraction * (upperTemperature - lowerTemperature));
+}
+
+double PseudoadiabatTable::getTemperatureOnCurveThrough(double temperature, double pressure, double newPressure, double wetBulbThetaGuess) const
+{
+    //find the pair of curves bracketing (temperature, pressure), starting from the curve of the guess
+    double guessPosition = (wetBulbThetaGuess - firstWetBulbTheta) / wetBulbThetaDelta;
+    size_t curve = static_cast<size_t>(std::min(std::max(guessPosition, 0.0), static_cast<double>(wetBulbThetaCount - 2)));
+
+    double lowerTemperature = getCurveTemperature(curve, pressure);
+    double upperTemperature = getCurveTemperature(curve + 1, pressure);
+
+    while (temperature < lowerTemperature && curve > 0)
+    {
+        curve--;
+        upperTemperature = lowerTemperature;
+        lowerTemperature = getCurveTemperature(curve, pressure);
+    }
+
+    while (temperature > upperTemperature && curve < wetBulbThetaCount - 2)
+    {
+        curve++;
+        lowerTemperature = upperTemperature;
+        upperTemperature = getCurveTemperature(curve + 1, pressure);
+    }
+
+    //follow the interpolated curve through the given state to the new pressure
+    double fraction = (temperature - lowerTemperature) / (upperTemperature - lowerTemperature);
+
+    double newLowerTemperature = getCurveTemperature(curve, newPressure);
+    double newUpperTemperature = getCurveTemperature(curve + 1, newPressure);
+
+    return newLowerTemperature + (fraction * (newUpperTemperature - newLowerTemperature));
+}
+
+bool PseudoadiabatTable::saveTo(const std::string& fileName) const
+{
+    //cache in host byte order, grid description in front so a different grid is never read back
+    std::ofstream file(fileName, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    const double grid[6] = { firstWetBulbTheta, wetBulbThetaDelta, static_cast<double>(wetBulbThetaCount), firstPressure, pressureDelta, static_cast<double>(pressureCount) };
+
+    file.write(tableCacheMagic, sizeof(tableCacheMagic));
+    file.write(reinterpret_cast<const char*>(grid), sizeof(grid));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+
+    return file.good();
+}
+
+bool PseudoadiabatTable::loadFrom(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    const double expectedGrid[6] = { firstWetBulbTheta, wetBulbThetaDelta, static_cast<double>(wetBulbThetaCount), firstPressure, pressureDelta, static_cast<double>(pressureCount) };
+    char magic[sizeof(tableCacheMagic)];
+    double grid[6];
+
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, tableCacheMagic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+
+    if (!file.read(reinterpret_cast<char*>(grid), sizeof(grid)) || std::memcmp(grid, expectedGrid, sizeof(grid)) != 0)
+    {
+        return false;
+    }
+
+    std::vector<double> loadedValues(wetBulbThetaCount * pressureCount);
+
+    if (!file.read(reinterpret_cast<char*>(loadedValues.data()), loadedValues.size() * sizeof(double)))
+    {
+        return false;
+    }
+
+    values = loadedValues;
+    return true;
+}
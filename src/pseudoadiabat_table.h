@@ -0,0 +1,39 @@
+#ifndef PSEUDOADIABAT_TABLE_H
+#define PSEUDOADIABAT_TABLE_H
+
+#include <string>
+#include <vector>
+
+//temperature along pseudoadiabats on a regular (wet-bulb potential temperature, pressure) grid
+//every curve is integrated once with the Runge-Kutta pseudoadiabat from its wet-bulb potential temperature at 1000 hPa
+class PseudoadiabatTable
+{
+public:
+	//grid: -40 to 50 C every 0.25 K, 1 to 1050 hPa every 0.5 hPa
+	static constexpr double firstWetBulbTheta = 233.15;
+	static constexpr double wetBulbThetaDelta = 0.25;
+	static constexpr size_t wetBulbThetaCount = 361;
+	static constexpr double firstPressure = 100.0;
+	static constexpr double pressureDelta = 50.0;
+	static constexpr size_t pressureCount = 2099;
+
+	//process-wide table of every cacheFileName, built on first use or read from the file when it holds a matching table
+	static const PseudoadiabatTable& getInstance(const std::string& cacheFileName);
+
+	PseudoadiabatTable();
+
+	double getTemperature(double wetBulbTheta, double pressure) const;
+	double getTemperatureOnCurveThrough(double temperature, double pressure, double newPressure, double wetBulbThetaGuess) const;
+
+	bool saveTo(const std::string& fileName) const;
+	bool loadFrom(const std::string& fileName);
+
+private:
+	//values[curve * pressureCount + level]
+	std::vector<double> values;
+
+	void build();
+	double getCurveTemperature(size_t curve, double pressure) const;
+};
+
+#endif
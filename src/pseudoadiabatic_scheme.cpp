@@ -1,10 +1,13 @@
 #include "thermodynamic_calc.h"
 #include "parcel.h"
 #include "pseudoadiabatic_scheme.h"
+#include "instrumentation.h"
 #include <cmath>
 
 double NumericalPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
 {
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+
     //input in Pa & K; output in K
     //Bakhshaii & Stull (2013)
 
@@ -54,56 +57,119 @@ double NumericalPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel
     return -999.0;
 }
 
-double FiniteDifferencePseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
+namespace
 {
-    double t = currentParcelSlice.temperature;
-    double rs = currentParcelSlice.mixingRatioSaturated;
-    double r = currentParcelSlice.mixingRatio;
-    double p = currentParcelSlice.pressure;
+    ParcelSlice<double> convertSlice(const ParcelSlice<float>& slice)
+    {
+        ParcelSlice<double> convertedSlice;
+        convertedSlice.position = slice.position;
+        convertedSlice.velocity = slice.velocity;
+        convertedSlice.pressure = slice.pressure;
+        convertedSlice.temperature = slice.temperature;
+        convertedSlice.temperatureVirtual = slice.temperatureVirtual;
+        convertedSlice.mixingRatio = slice.mixingRatio;
+        convertedSlice.mixingRatioSaturated = slice.mixingRatioSaturated;
+
+        return convertedSlice;
+    }
 
-    double b = (1 + (r/EPSILON)) / (1 + (r/(C_P/C_PV)));
-    double Ln = (b / p) * (((R_D * t) + (L_V * rs)) / (C_P + ((L_V * L_V * rs * EPSILON * b) / (R_D * t * t))));
-    double newTemperature = currentParcelSlice.temperature + (deltaPressure * Ln); //finite difference forward-time scheme
+    template <class Real>
+    Real calcFiniteDifferencePseudoadiabat(const ParcelSlice<Real>& currentParcelSlice, Real deltaPressure)
+    {
+        Real t = currentParcelSlice.temperature;
+        Real rs = currentParcelSlice.mixingRatioSaturated;
+        Real r = currentParcelSlice.mixingRatio;
+        Real p = currentParcelSlice.pressure;
 
-    return newTemperature;
-}
+        Real b = (Real(1) + (r/Real(EPSILON))) / (Real(1) + (r/Real(C_P/C_PV)));
+        Real Ln = (b / p) * (((Real(R_D) * t) + (Real(L_V) * rs)) / (Real(C_P) + ((Real(L_V) * Real(L_V) * rs * Real(EPSILON) * b) / (Real(R_D) * t * t))));
+        Real newTemperature = currentParcelSlice.temperature + (deltaPressure * Ln); //finite difference forward-time scheme
 
-double RungeKuttaPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
-{
-    double p, t, rs, r, b;
+        return newTemperature;
+    }
 
-    p = currentParcelSlice.pressure;
-    t = currentParcelSlice.temperature;
-    rs = currentParcelSlice.mixingRatioSaturated;
-    r = currentParcelSlice.mixingRatio;
-    b = (1.0 + (r / EPSILON)) / (1.0 + (r / (C_P / C_PV)));
+    template <class Real>
+    Real calcRungeKuttaPseudoadiabat(const ParcelSlice<Real>& currentParcelSlice, Real deltaPressure)
+    {
+        Real p, t, rs, r, b;
 
-    double K1 = (b / p) * (((R_D * t) + (L_V * rs)) / (C_P + ((L_V * L_V * rs * EPSILON * b) / (R_D * t * t))));
+        p = currentParcelSlice.pressure;
+        t = currentParcelSlice.temperature;
+        rs = currentParcelSlice.mixingRatioSaturated;
+        r = currentParcelSlice.mixingRatio;
+        b = (Real(1.0) + (r / Real(EPSILON))) / (Real(1.0) + (r / Real(C_P / C_PV)));
 
-    p = currentParcelSlice.pressure + (0.5 * deltaPressure);
-    t = currentParcelSlice.temperature + (0.5*K1*deltaPressure);
-    rs = calcMixingRatio(t, p);
-    r = rs;
-    b = (1.0 + (r / EPSILON)) / (1.0 + (r / (C_P / C_PV)));
+        Real K1 = (b / p) * (((Real(R_D) * t) + (Real(L_V) * rs)) / (Real(C_P) + ((Real(L_V) * Real(L_V) * rs * Real(EPSILON) * b) / (Real(R_D) * t * t))));
 
-    double K2 = (b / p) * (((R_D * t) + (L_V * rs)) / (C_P + ((L_V * L_V * rs * EPSILON * b) / (R_D * t * t))));
+        p = currentParcelSlice.pressure + (Real(0.5) * deltaPressure);
+        t = currentParcelSlice.temperature + (Real(0.5)*K1*deltaPressure);
+        rs = calcMixingRatio(t, p);
+        r = rs;
+        b = (Real(1.0) + (r / Real(EPSILON))) / (Real(1.0) + (r / Real(C_P / C_PV)));
 
-    p = currentParcelSlice.pressure + (0.5 * deltaPressure);
-    t = currentParcelSlice.temperature + (0.5 * K2 * deltaPressure);
-    rs = calcMixingRatio(t, p);
-    r = rs;
-    b = (1.0 + (r / EPSILON)) / (1.0 + (r / (C_P / C_PV)));
+        Real K2 = (b / p) * (((Real(R_D) * t) + (Real(L_V) * rs)) / (Real(C_P) + ((Real(L_V) * Real(L_V) * rs * Real(EPSILON) * b) / (Real(R_D) * t * t))));
 
-    double K3 = (b / p) * (((R_D * t) + (L_V * rs)) / (C_P + ((L_V * L_V * rs * EPSILON * b) / (R_D * t * t))));
+        p = currentParcelSlice.pressure + (Real(0.5) * deltaPressure);
+        t = currentParcelSlice.temperature + (Real(0.5) * K2 * deltaPressure);
+        rs = calcMixingRatio(t, p);
+        r = rs;
+        b = (Real(1.0) + (r / Real(EPSILON))) / (Real(1.0) + (r / Real(C_P / C_PV)));
 
-    p = currentParcelSlice.pressure + deltaPressure;
-    t = currentParcelSlice.temperature + (K3 * deltaPressure);
-    rs = calcMixingRatio(t, p);
-    r = rs;
-    b = (1.0 + (r / EPSILON)) / (1.0 + (r / (C_P / C_PV)));
+        Real K3 = (b / p) * (((Real(R_D) * t) + (Real(L_V) * rs)) / (Real(C_P) + ((Real(L_V) * Real(L_V) * rs * Real(EPSILON) * b) / (Real(R_D) * t * t))));
 
-    double K4 = (b / p) * (((R_D * t) + (L_V * rs)) / (C_P + ((L_V * L_V * rs * EPSILON * b) / (R_D * t * t))));
+        p = currentParcelSlice.pressure + deltaPressure;
+        t = currentParcelSlice.temperature + (K3 * deltaPressure);
+        rs = calcMixingRatio(t, p);
+        r = rs;
+        b = (Real(1.0) + (r / Real(EPSILON))) / (Real(1.0) + (r / Real(C_P / C_PV)));
 
-    double newTemperature = currentParcelSlice.temperature + ((1.0 / 6.0) * deltaPressure * (K1 + 2.0 * K2 + 2.0 * K3 + K4));
-    return newTemperature;
+        Real K4 = (b / p) * (((Real(R_D) * t) + (Real(L_V) * rs)) / (Real(C_P) + ((Real(L_V) * Real(L_V) * rs * Real(EPSILON) * b) / (Real(R_D) * t * t))));
+
+        Real newTemperature = currentParcelSlice.temperature + (Real(1.0 / 6.0) * deltaPressure * (K1 + Real(2.0) * K2 + Real(2.0) * K3 + K4));
+        return newTemperature;
+    }
+}
+
+float NumericalPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta)
+{
+    //the fit is evaluated in double
+    return static_cast<float>(calculateCurrentPseudoadiabaticTemperature(convertSlice(currentParcelSlice), double(deltaPressure), double(WetBulbTheta)));
+}
+
+double FiniteDifferencePseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
+{
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+    return calcFiniteDifferencePseudoadiabat(currentParcelSlice, deltaPressure);
+}
+
+float FiniteDifferencePseudoadiabat::calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta)
+{
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+    return calcFiniteDifferencePseudoadiabat(currentParcelSlice, deltaPressure);
+}
+
+double RungeKuttaPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
+{
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+    return calcRungeKuttaPseudoadiabat(currentParcelSlice, deltaPressure);
+}
+
+float RungeKuttaPseudoadiabat::calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta)
+{
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+    return calcRungeKuttaPseudoadiabat(currentParcelSlice, deltaPressure);
+}
+
+double TablePseudoadiabat::calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta)
+{
+    INSTRUMENT_COUNT(pseudoadiabatCalls);
+
+    //input in Pa & K; output in K
+    return table.getTemperatureOnCurveThrough(currentParcelSlice.temperature, currentParcelSlice.pressure, currentParcelSlice.pressure + deltaPressure, WetBulbTheta);
+}
+
+float TablePseudoadiabat::calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta)
+{
+    //the table is interpolated in double
+    return static_cast<float>(calculateCurrentPseudoadiabaticTemperature(convertSlice(currentParcelSlice), double(deltaPressure), double(WetBulbTheta)));
 }
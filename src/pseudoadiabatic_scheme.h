@@ -2,7 +2,10 @@
 #define PSEUDOADIABAT_H
 
 #include "parcel.h"
+#include "pseudoadiabat_table.h"
 
+//every scheme also has a float overload for floating_point=float
+//the finite difference and Runge-Kutta schemes compute in float, the fit and the table are evaluated in double and rounded
 class PseudoAdiabaticScheme
 {
 public:
@@ -13,33 +16,49 @@ private:
 
 };
 
-class FiniteDifferencePseudoadiabat : public PseudoAdiabaticScheme
+class FiniteDifferencePseudoadiabat final : public PseudoAdiabaticScheme
 {
 public:
 	FiniteDifferencePseudoadiabat() {};
 	double calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta);
+	float calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta);
 
 private:
 
 };
 
-class RungeKuttaPseudoadiabat : public PseudoAdiabaticScheme
+class RungeKuttaPseudoadiabat final : public PseudoAdiabaticScheme
 {
 public:
 	RungeKuttaPseudoadiabat() {};
 	double calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta);
+	float calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta);
 
 private:
 
 };
 
-class NumericalPseudoadiabat : public PseudoAdiabaticScheme
+class NumericalPseudoadiabat final : public PseudoAdiabaticScheme
 {
 public:
 	NumericalPseudoadiabat() {};
 	double calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta);
+	float calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta);
 
 private:
 
 };
+
+//follows the tabulated pseudoadiabat passing through the current parcel state
+//differs from the Runge-Kutta pseudoadiabat integrated in 0.1 hPa steps by less than 0.003 K (see accuracy.exe)
+class TablePseudoadiabat final : public PseudoAdiabaticScheme
+{
+public:
+	TablePseudoadiabat(const PseudoadiabatTable& table) : table(table) {};
+	double calculateCurrentPseudoadiabaticTemperature(Parcel::Slice currentParcelSlice, double deltaPressure, double WetBulbTheta);
+	float calculateCurrentPseudoadiabaticTemperature(ParcelSlice<float> currentParcelSlice, float deltaPressure, float WetBulbTheta);
+
+private:
+	const PseudoadiabatTable& table;
+};
 #endif
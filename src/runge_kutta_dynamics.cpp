@@ -3,11 +3,22 @@
 #include "parcel.h"
 #include "dynamic_scheme.h"
 #include "pseudoadiabatic_scheme.h"
+#include "instrumentation.h"
 #include <iostream>
 
-Parcel RungeKuttaDynamics::runSimulationOn(Parcel& passedParcel)
+template <class Pseudoadiabat, class Real>
+RungeKuttaDynamics<Pseudoadiabat, Real>::RungeKuttaDynamics(const Environment& environment, const Pseudoadiabat& pseudoadiabaticScheme) :
+	sourceEnvironment(environment),
+	convertedEnvironment(environment),
+	environment(convertedEnvironment.get()),
+	pseudoadiabaticScheme(pseudoadiabaticScheme)
 {
-	parcel = passedParcel;
+}
+
+template <class Pseudoadiabat, class Real>
+Parcel RungeKuttaDynamics<Pseudoadiabat, Real>::runSimulationOn(Parcel& passedParcel)
+{
+	parcel = convertParcel(passedParcel, environment);
 
 	while (isParcelWithinBounds())
 	{
@@ -15,14 +26,17 @@ Parcel RungeKuttaDynamics::runSimulationOn(Parcel& passedParcel)
 		ascentAlongPseudoAdiabat();
 	}
 
-	return parcel;
+	return convertParcel(parcel, sourceEnvironment);
 }
 
-void RungeKuttaDynamics::ascentAlongMoistAdiabat()
+template <class Pseudoadiabat, class Real>
+void RungeKuttaDynamics<Pseudoadiabat, Real>::ascentAlongMoistAdiabat()
 {
+	INSTRUMENT_PHASE(moistAdiabat);
+
 	//calculate ascent constants
-	double gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
-	double lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
+	Real gamma = calcGamma(parcel.mixingRatio[parcel.currentTimeStep]);
+	Real lambda = calcLambda(parcel.temperature[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep], gamma);
 
 	//loop through next timesteps
 	do
@@ -36,6 +50,7 @@ void RungeKuttaDynamics::ascentAlongMoistAdiabat()
 
 		//update parcel properties
 		parcel.currentTimeStep++;
+		INSTRUMENT_COUNT(timesteps);
 		parcel.updateCurrentDynamicsAndPressure();
 		parcel.updateCurrentThermodynamicsAdiabatically(lambda, gamma);
 	} while (parcel.mixingRatioSaturated[parcel.currentTimeStep] > parcel.mixingRatio[parcel.currentTimeStep]);
@@ -44,13 +59,13 @@ void RungeKuttaDynamics::ascentAlongMoistAdiabat()
 	parcel.mixingRatio[parcel.currentTimeStep] = parcel.mixingRatioSaturated[parcel.currentTimeStep];
 }
 
-void RungeKuttaDynamics::ascentAlongPseudoAdiabat()
+template <class Pseudoadiabat, class Real>
+void RungeKuttaDynamics<Pseudoadiabat, Real>::ascentAlongPseudoAdiabat()
 {
-	//create pseudodynamic scheme
-	std::unique_ptr<PseudoAdiabaticScheme> pseudoadiabaticScheme = choosePseudoAdiabaticScheme();
+	INSTRUMENT_PHASE(pseudoAdiabat);
 
 	//calculate wet-bulb potential temperature for pseudoadiabatic ascent
-	double wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
+	Real wetBulbPotentialTemp = calcWBPotentialTemperature(parcel.temperature[parcel.currentTimeStep], parcel.mixingRatio[parcel.currentTimeStep], parcel.mixingRatioSaturated[parcel.currentTimeStep], parcel.pressure[parcel.currentTimeStep]);
 
 	//loop through timesteps until point of no moisture
 	while (parcel.mixingRatio[parcel.currentTimeStep] > parcel.noMoistureTreshold && parcel.velocity[parcel.currentTimeStep] > 0)
@@ -63,122 +78,108 @@ void RungeKuttaDynamics::ascentAlongPseudoAdiabat()
 		makePseudoAdiabaticTimeStep(wetBulbPotentialTemp);
 
 		parcel.currentTimeStep++;
+		INSTRUMENT_COUNT(timesteps);
 		parcel.updateCurrentDynamicsAndPressure();
-		double pressureDelta = parcel.pressure[parcel.currentTimeStep] - parcel.pressure[parcel.currentTimeStep - 1];
-		parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme->calculateCurrentPseudoadiabaticTemperature(parcel.getSlice(-1), pressureDelta, wetBulbPotentialTemp);
+		Real pressureDelta = parcel.pressure[parcel.currentTimeStep] - parcel.pressure[parcel.currentTimeStep - 1];
+		parcel.temperature[parcel.currentTimeStep] = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(parcel.getSlice(-1), pressureDelta, wetBulbPotentialTemp);
 		parcel.updateCurrentThermodynamicsPseudoadiabatically();
 	}
 }
 
-void RungeKuttaDynamics::makeAdiabaticTimeStep(double lambda, double gamma)
+template <class Pseudoadiabat, class Real>
+void RungeKuttaDynamics<Pseudoadiabat, Real>::makeAdiabaticTimeStep(Real lambda, Real gamma)
 {
+	INSTRUMENT_TIMER(stepTime);
+	INSTRUMENT_ADD(stageEvaluations, 4);
+
 	//algorithm source: https://math.stackexchange.com/a/2023862
 
-	double stepTemperature, stepTemperatureVirtual, stepPressure;
-	Environment::Location stepLocation = parcel.currentLocation;
+	Real stepTemperature, stepTemperatureVirtual, stepPressure;
+	typename BasicEnvironment<Real>::Location stepLocation = parcel.currentLocation;
 
-	double C0 = parcel.velocity[parcel.currentTimeStep];
-	double K0 = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], Environment::getVirtualTemperatureAtLocation(parcel.currentLocation));
+	Real C0 = parcel.velocity[parcel.currentTimeStep];
+	Real K0 = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], environment.getVirtualTemperatureAtLocation(parcel.currentLocation));
 
-	double C1 = C0 + (0.5 * parcel.timeDelta * K0);
-	stepLocation.position = parcel.currentLocation.position + (0.5 * parcel.timeDelta * C0);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
-	stepTemperature = calcTemperatureInAdiabat(stepPressure, gamma, lambda);
+	Real C1 = C0 + (Real(0.5) * parcel.timeDelta * K0);
+	stepLocation.position = parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C0);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
+	stepTemperature = parcel.getTemperatureInAdiabat(stepPressure, gamma, lambda);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, parcel.mixingRatio[parcel.currentTimeStep]);
-	double K1 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K1 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	double C2 = C0 + (0.5 * parcel.timeDelta * K1);
-	stepLocation.position = parcel.currentLocation.position + (0.5 * parcel.timeDelta * C1);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
-	stepTemperature = calcTemperatureInAdiabat(stepPressure, gamma, lambda);
+	Real C2 = C0 + (Real(0.5) * parcel.timeDelta * K1);
+	stepLocation.position = parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C1);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
+	stepTemperature = parcel.getTemperatureInAdiabat(stepPressure, gamma, lambda);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, parcel.mixingRatio[parcel.currentTimeStep]);
-	double K2 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K2 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	double C3 = C0 + (parcel.timeDelta * K2);
+	Real C3 = C0 + (parcel.timeDelta * K2);
 	stepLocation.position = parcel.currentLocation.position + (parcel.timeDelta * C2);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
-	stepTemperature = calcTemperatureInAdiabat(stepPressure, gamma, lambda);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
+	stepTemperature = parcel.getTemperatureInAdiabat(stepPressure, gamma, lambda);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, parcel.mixingRatio[parcel.currentTimeStep]);
-	double K3 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K3 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + ((parcel.timeDelta / 6.0) * (C0 + 2 * C1 + 2 * C2 + C3));
-	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + ((parcel.timeDelta / 6.0) * (K0 + 2 * K1 + 2 * K2 + K3));
+	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (C0 + 2 * C1 + 2 * C2 + C3));
+	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (K0 + 2 * K1 + 2 * K2 + K3));
 
 }
 
-void RungeKuttaDynamics::makePseudoAdiabaticTimeStep(double wetBulbTemperature)
+template <class Pseudoadiabat, class Real>
+void RungeKuttaDynamics<Pseudoadiabat, Real>::makePseudoAdiabaticTimeStep(Real wetBulbTemperature)
 {
-	std::unique_ptr<PseudoAdiabaticScheme> pseudoadiabaticScheme = choosePseudoAdiabaticScheme();
+	INSTRUMENT_TIMER(stepTime);
+	INSTRUMENT_ADD(stageEvaluations, 4);
 
-	double stepTemperature, stepTemperatureVirtual, stepPressure, deltaPressure, stepMixingRatio;
-	Environment::Location stepLocation = parcel.currentLocation;
-	Parcel::Slice stepSlice = parcel.getSlice(0);
+	Real stepTemperature, stepTemperatureVirtual, stepPressure, deltaPressure, stepMixingRatio;
+	typename BasicEnvironment<Real>::Location stepLocation = parcel.currentLocation;
+	typename BasicParcel<Real>::Slice stepSlice = parcel.getSlice(0);
 
-	double C0 = parcel.velocity[parcel.currentTimeStep];
-	double K0 = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], Environment::getVirtualTemperatureAtLocation(parcel.currentLocation));
+	Real C0 = parcel.velocity[parcel.currentTimeStep];
+	Real K0 = calcBouyancyForce(parcel.temperatureVirtual[parcel.currentTimeStep], environment.getVirtualTemperatureAtLocation(parcel.currentLocation));
 
-	double C1 = C0 + (0.5 * parcel.timeDelta * K0);
-	stepLocation.position = parcel.currentLocation.position + (0.5 * parcel.timeDelta * C0);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
+	Real C1 = C0 + (Real(0.5) * parcel.timeDelta * K0);
+	stepLocation.position = parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C0);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
 	deltaPressure = stepPressure - stepSlice.pressure;
-	stepTemperature = pseudoadiabaticScheme->calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
-	stepMixingRatio = calcMixingRatio(stepTemperature, stepPressure);
+	stepTemperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
+	stepMixingRatio = parcel.getMixingRatio(stepTemperature, stepPressure);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, stepMixingRatio);
-	double K1 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K1 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	double C2 = C0 + (0.5 * parcel.timeDelta * K1);
-	stepLocation.position = parcel.currentLocation.position + (0.5 * parcel.timeDelta * C1);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
+	Real C2 = C0 + (Real(0.5) * parcel.timeDelta * K1);
+	stepLocation.position = parcel.currentLocation.position + (Real(0.5) * parcel.timeDelta * C1);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
 	deltaPressure = stepPressure - stepSlice.pressure;
-	stepTemperature = pseudoadiabaticScheme->calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
-	stepMixingRatio = calcMixingRatio(stepTemperature, stepPressure);
+	stepTemperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
+	stepMixingRatio = parcel.getMixingRatio(stepTemperature, stepPressure);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, stepMixingRatio);
-	double K2 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K2 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	double C3 = C0 + (parcel.timeDelta * K2);
+	Real C3 = C0 + (parcel.timeDelta * K2);
 	stepLocation.position = parcel.currentLocation.position + (parcel.timeDelta * C2);
-	stepLocation.updateSector();
-	stepPressure = Environment::getPressureAtLocation(stepLocation);
+	stepLocation.updateSector(environment);
+	stepPressure = environment.getPressureAtLocation(stepLocation);
 	deltaPressure = stepPressure - stepSlice.pressure;
-	stepTemperature = pseudoadiabaticScheme->calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
-	stepMixingRatio = calcMixingRatio(stepTemperature, stepPressure);
+	stepTemperature = pseudoadiabaticScheme.calculateCurrentPseudoadiabaticTemperature(stepSlice, deltaPressure, wetBulbTemperature);
+	stepMixingRatio = parcel.getMixingRatio(stepTemperature, stepPressure);
 	stepTemperatureVirtual = calcVirtualTemperature(stepTemperature, stepMixingRatio);
-	double K3 = calcBouyancyForce(stepTemperatureVirtual, Environment::getVirtualTemperatureAtLocation(stepLocation));
+	Real K3 = calcBouyancyForce(stepTemperatureVirtual, environment.getVirtualTemperatureAtLocation(stepLocation));
 
-	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + ((parcel.timeDelta / 6.0) * (C0 + 2.0 * C1 + 2.0 * C2 + C3));
-	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + ((parcel.timeDelta / 6.0) * (K0 + 2.0 * K1 + 2.0 * K2 + K3));
+	parcel.position[parcel.currentTimeStep + 1] = parcel.position[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (C0 + Real(2.0) * C1 + Real(2.0) * C2 + C3));
+	parcel.velocity[parcel.currentTimeStep + 1] = parcel.velocity[parcel.currentTimeStep] + ((parcel.timeDelta / Real(6.0)) * (K0 + Real(2.0) * K1 + Real(2.0) * K2 + K3));
 }
 
-std::unique_ptr<PseudoAdiabaticScheme> RungeKuttaDynamics::choosePseudoAdiabaticScheme()
+template <class Pseudoadiabat, class Real>
+bool RungeKuttaDynamics<Pseudoadiabat, Real>::isParcelWithinBounds()
 {
-	size_t pseudoadiabaticSchemeID = std::stoi(parcel.parcelConfiguration.at("pseudoadiabatic_scheme"));
-
-	if (pseudoadiabaticSchemeID == 1)
-	{
-		return std::make_unique<FiniteDifferencePseudoadiabat>();
-	}
-	else if (pseudoadiabaticSchemeID == 2)
-	{
-		return std::make_unique<RungeKuttaPseudoadiabat>();
-	}
-	else if (pseudoadiabaticSchemeID == 3)
-	{
-		return std::make_unique<NumericalPseudoadiabat>();
-	}
-	else
-	{
-		return nullptr;
-	}
-}
-
-bool RungeKuttaDynamics::isParcelWithinBounds()
-{
-	if (parcel.position[parcel.currentTimeStep] >= Environment::highestPoint)
+	if (parcel.position[parcel.currentTimeStep] >= environment.highestPoint)
 	{
 		return false;
 	}
@@ -195,4 +196,14 @@ bool RungeKuttaDynamics::isParcelWithinBounds()
 		return true;
 	}
 
-}
\ No newline at end of file
+}
+
+template class RungeKuttaDynamics<FiniteDifferencePseudoadiabat, float>;
+template class RungeKuttaDynamics<RungeKuttaPseudoadiabat, float>;
+template class RungeKuttaDynamics<NumericalPseudoadiabat, float>;
+template class RungeKuttaDynamics<TablePseudoadiabat, float>;
+
+template class RungeKuttaDynamics<FiniteDifferencePseudoadiabat, double>;
+template class RungeKuttaDynamics<RungeKuttaPseudoadiabat, double>;
+template class RungeKuttaDynamics<NumericalPseudoadiabat, double>;
+template class RungeKuttaDynamics<TablePseudoadiabat, double>;
@@ -0,0 +1,443 @@
+#include "environment.h"
+#include "parcel.h"
+#include "parcel_summary.h"
+#include "dynamic_scheme.h"
+#include "thread_pool.h"
+#include "server.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    std::vector<std::string> splitOn(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream textStream(text);
+        std::string part;
+
+        while (getline(textStream, part, separator))
+        {
+            parts.push_back(part);
+        }
+
+        return parts;
+    }
+
+    std::string formatValue(double value)
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%.5f", value);
+
+        return text;
+    }
+
+    //keys a request may override, anything that names files or output stays as configured by the server
+    const std::set<std::string> requestModelKeys = { "dynamic_scheme", "adaptive_tolerance" };
+    const std::set<std::string> requestParcelKeys = { "timestep", "period", "pseudoadiabatic_scheme", "thermo_precision", "floating_point",
+        "no_moisture_trsh", "init_velocity", "init_height", "init_temp", "init_dewpoint" };
+
+    //limits that keep one request from occupying a worker for long, timestep in s and period in h
+    const double minRequestTimestep = 0.01;
+    const double maxRequestPeriod = 24.0;
+
+    //below the lower tolerance every step of the adaptive scheme would shrink to its minimum size
+    const double minRequestTolerance = 1e-12;
+    const double maxRequestTolerance = 1e-2;
+
+    bool isNumberWithin(const std::string& value, double lowerLimit, double upperLimit)
+    {
+        try
+        {
+            size_t parsedLength;
+            double number = std::stod(value, &parsedLength);
+
+            return parsedLength == value.size() && number >= lowerLimit && number <= upperLimit;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    bool writeAll(int descriptor, const std::string& text)
+    {
+        size_t written = 0;
+
+        while (written < text.size())
+        {
+            ssize_t count = write(descriptor, text.data() + written, text.size() - written);
+
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            written += count;
+        }
+
+        return true;
+    }
+}
+
+EnvironmentCache::EnvironmentCache(size_t capacity) :
+    capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+std::shared_ptr<const Environment> EnvironmentCache::get(const std::string& fileName, bool& isCached)
+{
+    std::error_code error;
+    std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(fileName, error);
+
+    if (error)
+    {
+        throw std::runtime_error(fileName + ": cannot open the file");
+    }
+
+    auto found = index.find(fileName);
+
+    if (found != index.end())
+    {
+        if (found->second->modificationTime == modificationTime)
+        {
+            //move to the front as the most recently used
+            entries.splice(entries.begin(), entries, found->second);
+            isCached = true;
+
+            return entries.front().environment;
+        }
+
+        //the file changed since it was parsed
+        entries.erase(found->second);
+        index.erase(found);
+    }
+
+    isCached = false;
+    std::shared_ptr<const Environment> environment = std::make_shared<const Environment>(fileName);
+
+    entries.push_front({ fileName, modificationTime, environment });
+    index[fileName] = entries.begin();
+
+    if (entries.size() > capacity)
+    {
+        index.erase(entries.back().fileName);
+        entries.pop_back();
+    }
+
+    return environment;
+}
+
+SimulationServer::SimulationServer(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration) :
+    modelConfiguration(modelConfiguration),
+    parcelConfiguration(parcelConfiguration),
+    environmentCache(modelConfiguration.find("server_cache_size") != modelConfiguration.end() ? std::stoi(modelConfiguration.at("server_cache_size")) : 8),
+    servedRequests(0),
+    cachedRequests(0)
+{
+    size_t threadCount = modelConfiguration.find("threads") != modelConfiguration.end() ? std::stoi(modelConfiguration.at("threads")) : 0;
+    pool = std::make_unique<ThreadPool>(threadCount);
+
+    //every request is answered with diagnostics only, no output file is written
+    this->parcelConfiguration["output_mode"] = "summary";
+}
+
+bool SimulationServer::prepareRequest(const std::string& requestText, Request& request)
+{
+    //key=value overrides separated by spaces, model.conf keys go to the model configuration
+    request.modelConfiguration = modelConfiguration;
+    request.parcelConfiguration = parcelConfiguration;
+
+    std::stringstream requestStream(requestText);
+    std::string token;
+
+    while (requestStream >> token)
+    {
+        size_t separator = token.find('=');
+
+        if (separator == std::string::npos || separator == 0)
+        {
+            request.answer = "error malformed key=value pair '" + token + "'";
+            return false;
+        }
+
+        std::string key = token.substr(0, separator);
+        std::string value = token.substr(separator + 1);
+
+        if (key == "profile")
+        {
+            //only file names, so a request cannot reach files outside input
+            if (value.empty() || value.find('/') != std::string::npos || value.find("..") != std::string::npos)
+            {
+                request.answer = "error profile has to be the name of a file in input";
+                return false;
+            }
+
+            request.modelConfiguration["profile_filename"] = "input/" + value;
+        }
+        else if (requestModelKeys.count(key) > 0)
+        {
+            request.modelConfiguration[key] = value;
+        }
+        else if (requestParcelKeys.count(key) > 0)
+        {
+            request.parcelConfiguration[key] = value;
+        }
+        else
+        {
+            request.answer = "error " + key + " cannot be set in server mode";
+            return false;
+        }
+    }
+
+    if (!isNumberWithin(request.parcelConfiguration["timestep"], minRequestTimestep, 3600.0))
+    {
+        request.answer = "error timestep has to be a number of seconds from " + formatValue(minRequestTimestep);
+        return false;
+    }
+
+    if (!isNumberWithin(request.parcelConfiguration["period"], 0.0, maxRequestPeriod) || std::stod(request.parcelConfiguration["period"]) <= 0.0)
+    {
+        request.answer = "error period has to be a positive number of hours up to " + formatValue(maxRequestPeriod);
+        return false;
+    }
+
+    if (request.modelConfiguration.find("adaptive_tolerance") != request.modelConfiguration.end()
+        && !isNumberWithin(request.modelConfiguration["adaptive_tolerance"], minRequestTolerance, maxRequestTolerance))
+    {
+        request.answer = "error adaptive_tolerance has to be a number from 1e-12 to 1e-2";
+        return false;
+    }
+
+    try
+    {
+        request.environment = environmentCache.get(request.modelConfiguration.at("profile_filename"), request.isCached);
+    }
+    catch (const std::exception& error)
+    {
+        request.answer = std::string("error cannot load the profile: ") + error.what();
+        return false;
+    }
+
+    return true;
+}
+
+void SimulationServer::simulateRequest(Request& request) const
+{
+    try
+    {
+        std::unique_ptr<DynamicScheme> dynamicScheme = createDynamicScheme(request.modelConfiguration, request.parcelConfiguration, *request.environment);
+
+        if (dynamicScheme == nullptr)
+        {
+            request.answer = "error incorect value of dynamic_scheme, pseudoadiabatic_scheme or floating_point";
+            return;
+        }
+
+        Parcel parcel(*request.environment, request.parcelConfiguration);
+        parcel = dynamicScheme->runSimulationOn(parcel);
+        ParcelSummary summary = parcel.getSummary();
+
+        request.answer = std::string("ok cached=") + (request.isCached ? "1" : "0") + " cape=" + formatValue(summary.cape) + " cin=" + formatValue(summary.cin)
+            + " lcl_height=" + formatValue(summary.lclHeight) + " lcl_pressure=" + formatValue(summary.lclPressure) + " lfc_height=" + formatValue(summary.lfcHeight)
+            + " el_height=" + formatValue(summary.elHeight) + " max_velocity=" + formatValue(summary.maxVelocity) + " cloud_top_height=" + formatValue(summary.cloudTopHeight);
+    }
+    catch (const std::exception& error)
+    {
+        request.answer = std::string("error ") + error.what();
+    }
+}
+
+std::string SimulationServer::handleMessage(const std::string& message)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::string> requestTexts = splitOn(message, '|');
+    std::vector<Request> requests(requestTexts.size());
+    std::vector<size_t> runnable;
+    size_t messageCachedRequests = 0;
+
+    //profiles are looked up one request after another, the cache is not shared with the workers
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        if (prepareRequest(requestTexts[i], requests[i]))
+        {
+            runnable.push_back(i);
+            messageCachedRequests += requests[i].isCached ? 1 : 0;
+        }
+    }
+
+    //a single request runs right here, several ones in parallel
+    if (runnable.size() == 1)
+    {
+        simulateRequest(requests[runnable.front()]);
+    }
+    else
+    {
+        for (size_t i : runnable)
+        {
+            pool->submit([this, &requests, i]() { simulateRequest(requests[i]); });
+        }
+
+        pool->waitForAll();
+    }
+
+    servedRequests += requests.size();
+    cachedRequests += messageCachedRequests;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count() / 1000.0;
+
+    std::string answer;
+
+    for (const Request& request : requests)
+    {
+        answer += request.answer + "\n";
+    }
+
+    answer += "end requests=" + std::to_string(requests.size()) + " cached=" + std::to_string(messageCachedRequests) + " time_us=" + formatValue(duration)
+        + " total_requests=" + std::to_string(servedRequests) + " total_cached=" + std::to_string(cachedRequests) + "\n";
+
+    return answer;
+}
+
+bool SimulationServer::serveDescriptor(int descriptor, bool& isShutdown)
+{
+    //messages are lines; an empty line is ignored and 'shutdown' stops the server
+    std::string buffer;
+    char chunk[65536];
+
+    while (!isShutdown)
+    {
+        ssize_t count = read(descriptor, chunk, sizeof(chunk));
+
+        if (count <= 0)
+        {
+            return count == 0;
+        }
+
+        buffer.append(chunk, count);
+        size_t lineEnd;
+
+        while ((lineEnd = buffer.find('\n')) != std::string::npos)
+        {
+            std::string message = buffer.substr(0, lineEnd);
+            buffer.erase(0, lineEnd + 1);
+
+            if (!message.empty() && message.back() == '\r')
+            {
+                message.pop_back();
+            }
+
+            if (message == "shutdown")
+            {
+                isShutdown = true;
+                break;
+            }
+
+            if (message.empty())
+            {
+                continue;
+            }
+
+            if (!writeAll(descriptor == STDIN_FILENO ? STDOUT_FILENO : descriptor, handleMessage(message)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool SimulationServer::run()
+{
+    //a client that disconnects before reading its answer makes the write fail with EPIPE instead of killing the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    bool isShutdown = false;
+    auto socketName = modelConfiguration.find("server_socket");
+
+    //without a socket path the server talks over stdin and stdout until the end of input
+    if (socketName == modelConfiguration.end() || socketName->second.empty())
+    {
+        std::cout << "Serving requests on stdin" << std::endl;
+        bool isServed = serveDescriptor(STDIN_FILENO, isShutdown);
+
+        std::cout << "Server stopped after " << servedRequests << " requests, " << cachedRequests << " served from the profile cache\n";
+        return isServed;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (socketName->second.size() >= sizeof(address.sun_path))
+    {
+        std::cout << "Socket path " << socketName->second << " is too long\n";
+        return false;
+    }
+
+    std::strcpy(address.sun_path, socketName->second.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(address.sun_path);
+
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0)
+    {
+        std::cout << "Cannot listen on " << socketName->second << ": " << std::strerror(errno) << "\n";
+
+        if (listener >= 0)
+        {
+            close(listener);
+        }
+
+        return false;
+    }
+
+    std::cout << "Serving requests on " << socketName->second << std::endl;
+
+    //clients are served one after another, requests of one message run in parallel
+    while (!isShutdown)
+    {
+        int client = accept(listener, nullptr, nullptr);
+
+        if (client < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            std::cout << "Cannot accept connections on " << socketName->second << ": " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        //a failed read or write drops just this client
+        serveDescriptor(client, isShutdown);
+        close(client);
+    }
+
+    close(listener);
+    unlink(address.sun_path);
+
+    std::cout << "Server stopped after " << servedRequests << " requests, " << cachedRequests << " served from the profile cache\n";
+
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "environment.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+//parsed profiles kept between requests, least recently used one is dropped when the cache is full
+//an entry is valid only for the modification time of the file it was read from
+class EnvironmentCache
+{
+public:
+	EnvironmentCache(size_t capacity);
+
+	//throws std::runtime_error when the profile cannot be read
+	std::shared_ptr<const Environment> get(const std::string& fileName, bool& isCached);
+
+private:
+	struct Entry
+	{
+		std::string fileName;
+		std::filesystem::file_time_type modificationTime;
+		std::shared_ptr<const Environment> environment;
+	};
+
+	size_t capacity;
+	std::list<Entry> entries; //most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+//long-running simulation service (run_mode=server) reading messages from stdin or a UNIX domain socket (server_socket)
+//a message is one line of requests separated by '|', a request is a list of key=value overrides of the parcel and scheme keys
+//of model.conf and parcel.conf (no file names or output settings), with profile=<file in input> selecting the sounding;
+//every request is answered with one line of parcel diagnostics and every message ends with a line counting its requests and those served from the profile cache
+class SimulationServer
+{
+private:
+	struct Request
+	{
+		std::map<std::string, std::string> modelConfiguration, parcelConfiguration;
+		std::shared_ptr<const Environment> environment;
+		bool isCached = false;
+		std::string answer;
+	};
+
+	std::map<std::string, std::string> modelConfiguration, parcelConfiguration;
+	EnvironmentCache environmentCache;
+	std::unique_ptr<ThreadPool> pool;
+	size_t servedRequests, cachedRequests;
+
+	bool prepareRequest(const std::string& requestText, Request& request);
+	void simulateRequest(Request& request) const;
+	bool serveDescriptor(int descriptor, bool& isShutdown);
+
+public:
+	SimulationServer(const std::map<std::string, std::string>& modelConfiguration, const std::map<std::string, std::string>& parcelConfiguration);
+
+	//answer of one message, one line per request and the closing line, each ending with '\n'
+	std::string handleMessage(const std::string& message);
+	bool run();
+};
+
+#endif
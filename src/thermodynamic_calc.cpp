@@ -1,75 +1,249 @@
 #include "thermodynamic_calc.h"
+#include "vector_math.h"
 #include <cmath>
 
-double calcVapourPressure(double temperature, double pressure)
+template <class Real>
+Real calcVapourPressure(Real temperature, Real pressure)
 {
    //input in K & Pa; output in ratio of Pa
-   temperature -= 273.15; //convert to C
-   pressure /= 100.0; //convert to hPa
+   temperature -= Real(273.15); //convert to C
+   pressure /= Real(100.0); //convert to hPa
    
-   const double a = 6.1121;
-   const double b = 18.729;
-   const double c = 257.87;
-   const double d = 227.3;
+   const Real a = Real(6.1121);
+   const Real b = Real(18.729);
+   const Real c = Real(257.87);
+   const Real d = Real(227.3);
    
-   const double A = 0.00072; 
-   const double B = 0.0000032;
-   const double C = 0.00000000059;
+   const Real A = Real(0.00072); 
+   const Real B = Real(0.0000032);
+   const Real C = Real(0.00000000059);
    
-   const double e = a * exp(((b - (temperature / d)) * temperature)/(temperature + c));
-   const double f = 1.0 + A + (pressure * (B + (C * temperature * temperature)));
+   const Real e = a * std::exp(((b - (temperature / d)) * temperature)/(temperature + c));
+   const Real f = Real(1.0) + A + (pressure * (B + (C * temperature * temperature)));
    
-   return (e * f) * 100.0; //return in Pa  
+   return (e * f) * Real(100.0); //return in Pa  
 }
 
-double calcMixingRatio(double temperature, double pressure)
+template <class Real>
+Real calcMixingRatio(Real temperature, Real pressure)
 {
     //input in K & Pa; output in ratio of kg/kg
     //function for caluclating both mixing ratio and saturation mixing ratio
 
     //first calculate (saturation) vapour pressure
-    double wvpres = calcVapourPressure(temperature, pressure);
+    Real wvpres = calcVapourPressure(temperature, pressure);
 
     //second return calculated mixing ratio
-    return EPSILON * (wvpres / (pressure - wvpres));
+    return Real(EPSILON) * (wvpres / (pressure - wvpres));
 }
 
-double calcVirtualTemperature(double temperature, double mixRatio)
+template <class Real>
+Real calcVirtualTemperature(Real temperature, Real mixRatio)
 {
     //input in K & Pa/Pa, output in K
-    return temperature * ((1.0 + (mixRatio / EPSILON)) / (1.0 + mixRatio));
+    return temperature * ((Real(1.0) + (mixRatio / Real(EPSILON))) / (Real(1.0) + mixRatio));
 }
 
-double calcTemperatureInAdiabat(double pressure, double gamma, double lambda)
+template <class Real>
+Real calcTemperatureInAdiabat(Real pressure, Real gamma, Real lambda)
 {
     //input in K; output in K
-    return pow(lambda / pow(pressure, 1.0 - gamma), 1.0 / gamma);
+    return std::pow(lambda / std::pow(pressure, Real(1.0) - gamma), Real(1.0) / gamma);
 }
 
-double calcBouyancyForce(double parcelTv, double envTv)
+template <class Real>
+Real calcBouyancyForce(Real parcelTv, Real envTv)
 {
-    return G * ((parcelTv - envTv) / envTv);
+    return Real(G) * ((parcelTv - envTv) / envTv);
 }
 
-double calcWBPotentialTemperature(double temperature, double mixingRatio, double satMixingRatio, double pressure)
+template <class Real>
+Real calcWBPotentialTemperature(Real temperature, Real mixingRatio, Real satMixingRatio, Real pressure)
 {
     //input in K & kg/kg & Pa; output in K
-    double vapourPressure = calcVapourPressure(temperature, pressure);
-    double dryTemperature = temperature * pow(100000.0 / ((pressure - vapourPressure)), 0.2854);
-    double equiTemperature = dryTemperature * pow(mixingRatio / satMixingRatio, -(0.2854 * (mixingRatio / EPSILON))) * exp((2555000.0 * mixingRatio) / (C_P * temperature)); //Bryan (2008)
-    double wetTemperature = (45.114 - (51.489 * pow(273.15 / equiTemperature, 3.504))) + 273.15;
+    Real vapourPressure = calcVapourPressure(temperature, pressure);
+    Real dryTemperature = temperature * std::pow(Real(100000.0) / ((pressure - vapourPressure)), Real(0.2854));
+    Real equiTemperature = dryTemperature * std::pow(mixingRatio / satMixingRatio, -(Real(0.2854) * (mixingRatio / Real(EPSILON)))) * std::exp((Real(2555000.0) * mixingRatio) / (Real(C_P) * temperature)); //Bryan (2008)
+    Real wetTemperature = (Real(45.114) - (Real(51.489) * std::pow(Real(273.15) / equiTemperature, Real(3.504)))) + Real(273.15);
 
     return wetTemperature;
 }
 
-double calcGamma(double mixingRatio)
+template <class Real>
+Real calcGamma(Real mixingRatio)
 {
-    double gamma = (C_P * ((1.0 + (mixingRatio * (C_PV / C_P))) / (1.0 + mixingRatio))) / (C_V * ((1.0 + (mixingRatio * (C_VV / C_V))) / (1.0 + mixingRatio))); //Bailyn (1994)
+    Real gamma = (Real(C_P) * ((Real(1.0) + (mixingRatio * Real(C_PV / C_P))) / (Real(1.0) + mixingRatio))) / (Real(C_V) * ((Real(1.0) + (mixingRatio * Real(C_VV / C_V))) / (Real(1.0) + mixingRatio))); //Bailyn (1994)
     return gamma;
 }
 
-double calcLambda(double temperature, double pressure, double gamma)
+template <class Real>
+Real calcLambda(Real temperature, Real pressure, Real gamma)
 {
-    double lambda = pow(pressure, 1.0 - gamma) * pow(temperature, gamma);
+    Real lambda = std::pow(pressure, Real(1.0) - gamma) * std::pow(temperature, gamma);
     return lambda;
 }
+
+namespace
+{
+    //saturation vapour pressure over water without the pressure enhancement factor, in Pa, every 0.05 K from -100 C to 70 C
+    class SaturationTable
+    {
+    public:
+        static constexpr double minTemperature = 173.15;
+        static constexpr double temperatureStep = 0.05;
+        static constexpr size_t size = 3401;
+
+        double values[size];
+
+        SaturationTable()
+        {
+            for (size_t i = 0; i < size; i++)
+            {
+                double temperature = (minTemperature + (i * temperatureStep)) - 273.15;
+                values[i] = 611.21 * exp(((18.729 - (temperature / 227.3)) * temperature) / (temperature + 257.87));
+            }
+        }
+    };
+
+    const SaturationTable saturationTable;
+}
+
+template <class Real>
+Real calcVapourPressureFast(Real temperature, Real pressure)
+{
+    //input in K & Pa; output in Pa
+    //linear interpolation in the table, exact formula outside of it
+    Real index = (temperature - Real(SaturationTable::minTemperature)) / Real(SaturationTable::temperatureStep);
+
+    if (!(index >= Real(0.0) && index < Real(SaturationTable::size - 1)))
+    {
+        return calcVapourPressure(temperature, pressure);
+    }
+
+    size_t lowerIndex = static_cast<size_t>(index);
+    Real weight = index - lowerIndex;
+    Real e = Real(saturationTable.values[lowerIndex]) + (weight * (Real(saturationTable.values[lowerIndex + 1]) - Real(saturationTable.values[lowerIndex])));
+
+    temperature -= Real(273.15);
+    pressure /= Real(100.0);
+    const Real f = Real(1.0) + Real(0.00072) + (pressure * (Real(0.0000032) + (Real(0.00000000059) * temperature * temperature)));
+
+    return e * f;
+}
+
+template <class Real>
+Real calcMixingRatioFast(Real temperature, Real pressure)
+{
+    Real wvpres = calcVapourPressureFast(temperature, pressure);
+    return Real(EPSILON) * (wvpres / (pressure - wvpres));
+}
+
+template <class Real>
+Real calcTemperatureInAdiabatFast(Real pressure, Real gamma, Real lambda, AdiabatConstants& constants)
+{
+    //(lambda / p^(1 - gamma))^(1 / gamma) = lambda^(1 / gamma) * p^((gamma - 1) / gamma)
+    if (gamma != constants.gamma || lambda != constants.lambda)
+    {
+        constants.gamma = gamma;
+        constants.lambda = lambda;
+        constants.scale = std::pow(lambda, Real(1.0) / gamma);
+        constants.exponent = (gamma - Real(1.0)) / gamma;
+    }
+
+    return Real(constants.scale) * std::pow(pressure, Real(constants.exponent));
+}
+
+template float calcVapourPressure<float>(float, float);
+template float calcMixingRatio<float>(float, float);
+template float calcVirtualTemperature<float>(float, float);
+template float calcTemperatureInAdiabat<float>(float, float, float);
+template float calcBouyancyForce<float>(float, float);
+template float calcWBPotentialTemperature<float>(float, float, float, float);
+template float calcGamma<float>(float);
+template float calcLambda<float>(float, float, float);
+template float calcVapourPressureFast<float>(float, float);
+template float calcMixingRatioFast<float>(float, float);
+template float calcTemperatureInAdiabatFast<float>(float, float, float, AdiabatConstants&);
+
+template double calcVapourPressure<double>(double, double);
+template double calcMixingRatio<double>(double, double);
+template double calcVirtualTemperature<double>(double, double);
+template double calcTemperatureInAdiabat<double>(double, double, double);
+template double calcBouyancyForce<double>(double, double);
+template double calcWBPotentialTemperature<double>(double, double, double, double);
+template double calcGamma<double>(double);
+template double calcLambda<double>(double, double, double);
+template double calcVapourPressureFast<double>(double, double);
+template double calcMixingRatioFast<double>(double, double);
+template double calcTemperatureInAdiabatFast<double>(double, double, double, AdiabatConstants&);
+
+//runtime dispatch between AVX-512, AVX2 and baseline builds of the array kernels (GCC function multiversioning)
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__clang__)
+#define ARRAY_KERNEL __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define ARRAY_KERNEL
+#endif
+
+namespace
+{
+    inline double calcVapourPressureElement(double temperature, double pressure)
+    {
+        //same approximation as the scalar calcVapourPressure, with the vectorizable exp
+        temperature -= 273.15;
+        pressure /= 100.0;
+
+        const double e = 6.1121 * vectorExp(((18.729 - (temperature / 227.3)) * temperature) / (temperature + 257.87));
+        const double f = 1.0 + 0.00072 + (pressure * (0.0000032 + (0.00000000059 * temperature * temperature)));
+
+        return (e * f) * 100.0;
+    }
+}
+
+ARRAY_KERNEL
+void calcVapourPressure(const double* __restrict temperature, const double* __restrict pressure, double* __restrict vapourPressure, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        vapourPressure[i] = calcVapourPressureElement(temperature[i], pressure[i]);
+    }
+}
+
+ARRAY_KERNEL
+void calcMixingRatio(const double* __restrict temperature, const double* __restrict pressure, double* __restrict mixingRatio, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        double wvpres = calcVapourPressureElement(temperature[i], pressure[i]);
+        mixingRatio[i] = EPSILON * (wvpres / (pressure[i] - wvpres));
+    }
+}
+
+ARRAY_KERNEL
+void calcVirtualTemperature(const double* __restrict temperature, const double* __restrict mixRatio, double* __restrict virtualTemperature, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        virtualTemperature[i] = temperature[i] * ((1.0 + (mixRatio[i] / EPSILON)) / (1.0 + mixRatio[i]));
+    }
+}
+
+ARRAY_KERNEL
+void calcTemperatureInAdiabat(const double* __restrict pressure, const double* __restrict gamma, const double* __restrict lambda, double* __restrict temperature, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        temperature[i] = vectorPow(lambda[i] / vectorPow(pressure[i], 1.0 - gamma[i]), 1.0 / gamma[i]);
+    }
+}
+
+ARRAY_KERNEL
+void calcWBPotentialTemperature(const double* __restrict temperature, const double* __restrict mixingRatio, const double* __restrict satMixingRatio, const double* __restrict pressure, double* __restrict wetBulbPotentialTemperature, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        double vapourPressure = calcVapourPressureElement(temperature[i], pressure[i]);
+        double dryTemperature = temperature[i] * vectorPow(100000.0 / ((pressure[i] - vapourPressure)), 0.2854);
+        double equiTemperature = dryTemperature * vectorPow(mixingRatio[i] / satMixingRatio[i], -(0.2854 * (mixingRatio[i] / EPSILON))) * vectorExp((2555000.0 * mixingRatio[i]) / (C_P * temperature[i])); //Bryan (2008)
+        wetBulbPotentialTemperature[i] = (45.114 - (51.489 * vectorPow(273.15 / equiTemperature, 3.504))) + 273.15;
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef THERMODYNAMICS_H
 #define THERMODYNAMICS_H
 
+#include <cstddef>
+
 //externaly defined constants
 double const G = 9.80665; //gravitational acceleration in m*s^-2
 double const R = 8.31446261815324; //J K^-1 mol^-1 universal gas constant
@@ -19,20 +21,59 @@ double const L_V = 2500800.0; //J kg^1 latent heat of vapourization of water (EC
 double const EPSILON = M_V / M_D; //ratio of molar masses of dry air and water vapour
 double const R_D = R / M_D; //specific gas constant for dry air
 
-double calcVapourPressure(double temperature, double pressure);
+//scalar functions are instantiated for float and double (floating_point in parcel.conf), constants are rounded to the argument type
+template <class Real>
+Real calcVapourPressure(Real temperature, Real pressure);
+
+template <class Real>
+Real calcMixingRatio(Real temperature, Real pressure);
+
+template <class Real>
+Real calcVirtualTemperature(Real temperature, Real mixRatio);
+
+template <class Real>
+Real calcTemperatureInAdiabat(Real pressure, Real gamma, Real lambda);
+
+template <class Real>
+Real calcBouyancyForce(Real parcelTv, Real envTv);
+
+template <class Real>
+Real calcWBPotentialTemperature(Real temperature, Real mixingRatio, Real satMixingRatio, Real pressure);
+
+template <class Real>
+Real calcGamma(Real mixingRatio);
+
+template <class Real>
+Real calcLambda(Real temperature, Real pressure, Real gamma);
+
+//thermo_precision=fast versions: saturation vapour pressure interpolated in a table built once per program,
+//adiabat temperature from a single power with the exponents computed once per ascent segment
+struct AdiabatConstants
+{
+	double gamma = 0, lambda = 0;
+	double scale = 0, exponent = 0; //T = scale * p^exponent
+};
+
+template <class Real>
+Real calcVapourPressureFast(Real temperature, Real pressure);
 
-double calcMixingRatio(double temperature, double pressure);
+template <class Real>
+Real calcMixingRatioFast(Real temperature, Real pressure);
 
-double calcVirtualTemperature(double temperature, double mixRatio);
+//constants are recomputed only when gamma or lambda differ from the ones they were computed for
+template <class Real>
+Real calcTemperatureInAdiabatFast(Real pressure, Real gamma, Real lambda, AdiabatConstants& constants);
 
-double calcTemperatureInAdiabat(double pressure, double gamma, double lambda);
+//array versions: element i of the result is computed from element i of every input
+//vectorized with AVX-512 or AVX2 when the CPU supports it, plain loop otherwise
+void calcVapourPressure(const double* temperature, const double* pressure, double* vapourPressure, size_t count);
 
-double calcBouyancyForce(double parcelTv, double envTv);
+void calcMixingRatio(const double* temperature, const double* pressure, double* mixingRatio, size_t count);
 
-double calcWBPotentialTemperature(double temperature, double mixingRatio, double satMixingRatio, double pressure);
+void calcVirtualTemperature(const double* temperature, const double* mixRatio, double* virtualTemperature, size_t count);
 
-double calcGamma(double mixingRatio);
+void calcTemperatureInAdiabat(const double* pressure, const double* gamma, const double* lambda, double* temperature, size_t count);
 
-double calcLambda(double temperature, double pressure, double gamma);
+void calcWBPotentialTemperature(const double* temperature, const double* mixingRatio, const double* satMixingRatio, const double* pressure, double* wetBulbPotentialTemperature, size_t count);
 
 #endif
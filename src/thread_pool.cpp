@@ -0,0 +1,176 @@
+#include "thread_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    //index of the pool worker running on this thread (none for external threads)
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorkerIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    queuedTasks(0),
+    unfinishedTasks(0),
+    nextQueue(0),
+    stopping(false)
+{
+    threadCount = resolveThreadCount(threadCount);
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    waitForAll();
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::resolveThreadCount(size_t requestedThreads)
+{
+    //zero means one worker per hardware thread
+    if (requestedThreads > 0)
+    {
+        return requestedThreads;
+    }
+
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    //tasks spawned by a worker stay local, external tasks are dealt round-robin
+    size_t queueIndex;
+
+    if (currentPool == this)
+    {
+        queueIndex = currentWorkerIndex;
+    }
+    else
+    {
+        queueIndex = nextQueue.fetch_add(1) % queues.size();
+    }
+
+    unfinishedTasks++;
+    queuedTasks++;
+
+    {
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+    }
+
+    {
+        //taking the lock orders this wake-up after any worker that is about to sleep
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::waitForAll()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allTasksDone.wait(lock, [this] { return unfinishedTasks == 0; });
+}
+
+void ThreadPool::workerLoop(size_t workerIndex)
+{
+    currentPool = this;
+    currentWorkerIndex = workerIndex;
+
+    std::function<void()> task;
+
+    while (true)
+    {
+        if (popOwnTask(workerIndex, task) || stealTask(workerIndex, task))
+        {
+            task();
+            task = nullptr;
+
+            if (unfinishedTasks.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                allTasksDone.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        taskAvailable.wait(lock, [this] { return stopping || queuedTasks > 0; });
+
+        if (stopping && queuedTasks == 0)
+        {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popOwnTask(size_t workerIndex, std::function<void()>& task)
+{
+    WorkerQueue& queue = *queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queuedTasks--;
+
+    return true;
+}
+
+bool ThreadPool::stealTask(size_t workerIndex, std::function<void()>& task)
+{
+    //visit the other queues starting from the neighbour to spread contention
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        WorkerQueue& victim = *queues[(workerIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tasks.empty())
+        {
+            continue;
+        }
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queuedTasks--;
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//work-stealing pool: every worker owns a task queue, takes work from its back
+//and steals from the front of other queues once its own queue runs dry
+class ThreadPool
+{
+public:
+	ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	void submit(std::function<void()> task);
+	void waitForAll();
+	size_t size() const;
+
+	static size_t resolveThreadCount(size_t requestedThreads);
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex stateMutex;
+	std::condition_variable taskAvailable, allTasksDone;
+	std::atomic<size_t> queuedTasks, unfinishedTasks, nextQueue;
+	bool stopping;
+
+	void workerLoop(size_t workerIndex);
+	bool popOwnTask(size_t workerIndex, std::function<void()>& task);
+	bool stealTask(size_t workerIndex, std::function<void()>& task);
+};
+
+#endif
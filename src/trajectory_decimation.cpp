@@ -0,0 +1,167 @@
+#include "trajectory_decimation.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TrajectoryDecimation::TrajectoryDecimation() :
+    mode(Mode::none),
+    rows(0),
+    interval(0.0),
+    steps(0),
+    previousTime(0.0),
+    previousValues()
+{
+}
+
+TrajectoryDecimation::TrajectoryDecimation(const std::map<std::string, std::string>& parcelConfiguration) :
+    TrajectoryDecimation()
+{
+    auto decimation = parcelConfiguration.find("output_decimation");
+
+    if (decimation == parcelConfiguration.end())
+    {
+        return;
+    }
+
+    if (decimation->second == "time" || decimation->second == "height")
+    {
+        mode = decimation->second == "time" ? Mode::time : Mode::height;
+        interval = std::stod(parcelConfiguration.at("output_interval"));
+
+        if (!(interval > 0.0))
+        {
+            mode = Mode::none;
+        }
+    }
+    else if (decimation->second == "pressure")
+    {
+        //levels in hPa separated by spaces, kept in Pa from the bottom up
+        std::stringstream levelStream(parcelConfiguration.at("output_pressure_levels"));
+        double level;
+
+        while (levelStream >> level)
+        {
+            pressureLevels.push_back(level * 100.0);
+        }
+
+        std::sort(pressureLevels.begin(), pressureLevels.end(), std::greater<double>());
+        pressureLevels.erase(std::unique(pressureLevels.begin(), pressureLevels.end()), pressureLevels.end());
+
+        mode = pressureLevels.empty() ? Mode::none : Mode::pressure;
+    }
+}
+
+void TrajectoryDecimation::addStep(double stepTime, const double (&values)[fieldCount])
+{
+    double coordinate = getCoordinate(stepTime, values);
+
+    if (steps == 0)
+    {
+        //starting point only when it lies exactly on a level
+        bool isOnLevel = false;
+
+        if (mode == Mode::pressure)
+        {
+            isOnLevel = std::binary_search(pressureLevels.begin(), pressureLevels.end(), coordinate, std::greater<double>());
+        }
+        else if (mode != Mode::none)
+        {
+            isOnLevel = std::fmod(coordinate, interval) == 0.0;
+        }
+
+        if (isOnLevel)
+        {
+            addRow(1.0, stepTime, values);
+        }
+    }
+    else if (mode != Mode::none)
+    {
+        addLevelsBetween(getCoordinate(previousTime, previousValues), coordinate, stepTime, values);
+    }
+
+    steps++;
+    previousTime = stepTime;
+    std::copy(values, values + fieldCount, previousValues);
+}
+
+double TrajectoryDecimation::getCoordinate(double stepTime, const double (&values)[fieldCount]) const
+{
+    if (mode == Mode::time)
+    {
+        return stepTime;
+    }
+    else if (mode == Mode::height)
+    {
+        return values[0];
+    }
+    else
+    {
+        return values[2];
+    }
+}
+
+void TrajectoryDecimation::addLevelsBetween(double previousCoordinate, double coordinate, double stepTime, const double (&values)[fieldCount])
+{
+    //levels in (previousCoordinate, coordinate], in the order the parcel passes them
+    if (coordinate == previousCoordinate)
+    {
+        return;
+    }
+
+    bool isIncreasing = coordinate > previousCoordinate;
+    std::vector<double> levels;
+
+    if (mode == Mode::pressure)
+    {
+        //levels are sorted descending, a descending parcel passes them from the end
+        if (isIncreasing)
+        {
+            auto first = std::lower_bound(pressureLevels.begin(), pressureLevels.end(), coordinate, std::greater<double>());
+            auto last = std::lower_bound(pressureLevels.begin(), pressureLevels.end(), previousCoordinate, std::greater<double>());
+            levels.assign(std::make_reverse_iterator(last), std::make_reverse_iterator(first));
+        }
+        else
+        {
+            auto first = std::upper_bound(pressureLevels.begin(), pressureLevels.end(), previousCoordinate, std::greater<double>());
+            auto last = std::upper_bound(pressureLevels.begin(), pressureLevels.end(), coordinate, std::greater<double>());
+            levels.assign(first, last);
+        }
+    }
+    else
+    {
+        double first = isIncreasing ? std::floor(previousCoordinate / interval) + 1.0 : std::ceil(previousCoordinate / interval) - 1.0;
+        double last = isIncreasing ? std::floor(coordinate / interval) : std::ceil(coordinate / interval);
+
+        for (double k = first; isIncreasing ? k <= last : k >= last; k += isIncreasing ? 1.0 : -1.0)
+        {
+            levels.push_back(k * interval);
+        }
+    }
+
+    for (double level : levels)
+    {
+        addRow((level - previousCoordinate) / (coordinate - previousCoordinate), stepTime, values);
+
+        //the level itself rather than its interpolation, which may differ in the last digits
+        TrajectoryField& coordinateField = mode == Mode::time ? time : (mode == Mode::height ? fields[0] : fields[2]);
+        coordinateField[rows - 1] = level;
+    }
+}
+
+void TrajectoryDecimation::addRow(double weight, double stepTime, const double (&values)[fieldCount])
+{
+    //weight 0 is the previous step, 1 the current one
+    time[rows] = previousTime + (weight * (stepTime - previousTime));
+
+    for (size_t j = 0; j < fieldCount; j++)
+    {
+        fields[j][rows] = previousValues[j] + (weight * (values[j] - previousValues[j]));
+    }
+
+    rows++;
+}
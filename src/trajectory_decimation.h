@@ -0,0 +1,43 @@
+#ifndef TRAJECTORY_DECIMATION_H
+#define TRAJECTORY_DECIMATION_H
+
+#include "trajectory_field.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+//output rows at regular times, at regular heights or at pressure levels (output_decimation in parcel.conf)
+//collected step by step, so the trajectory itself does not have to be kept
+//values at a level are interpolated linearly between the two timesteps around it, every crossing of a level gives a row
+class TrajectoryDecimation
+{
+public:
+	enum class Mode { none, time, height, pressure };
+
+	//position, velocity, pressure, temperature, virtual temperature, mixing ratio, saturation mixing ratio
+	static const size_t fieldCount = 7;
+
+	Mode mode;
+	TrajectoryField time; //s
+	TrajectoryField fields[fieldCount];
+	size_t rows;
+
+	TrajectoryDecimation();
+	TrajectoryDecimation(const std::map<std::string, std::string>& parcelConfiguration);
+
+	void addStep(double stepTime, const double (&values)[fieldCount]);
+
+private:
+	double interval; //s or m
+	std::vector<double> pressureLevels; //Pa, descending
+	size_t steps;
+	double previousTime;
+	double previousValues[fieldCount];
+
+	double getCoordinate(double stepTime, const double (&values)[fieldCount]) const;
+	void addLevelsBetween(double previousCoordinate, double coordinate, double stepTime, const double (&values)[fieldCount]);
+	void addRow(double weight, double stepTime, const double (&values)[fieldCount]);
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TRAJECTORY_FIELD_H
+#define TRAJECTORY_FIELD_H
+
+#include <cstddef>
+#include <vector>
+
+//series of values indexed by timestep, allocated in fixed-size chunks as the simulation writes them
+template <class Real>
+class BasicTrajectoryField
+{
+public:
+	static const size_t chunkShift = 12;
+	static const size_t chunkSize = size_t(1) << chunkShift; //values per chunk (32 kB for double)
+
+	BasicTrajectoryField() : indexMask(~size_t(0)) {};
+
+	//same timesteps in another floating-point type
+	template <class Other>
+	explicit BasicTrajectoryField(const BasicTrajectoryField<Other>& other) : indexMask(other.indexMask)
+	{
+		for (const std::vector<Other>& chunk : other.chunks)
+		{
+			chunks.emplace_back(chunk.begin(), chunk.end());
+		}
+	}
+
+	//keep only the latest rollingSize values (a power of two), older timesteps are overwritten
+	void makeRolling(size_t rollingSize)
+	{
+		indexMask = rollingSize - 1;
+		chunks.assign(1, std::vector<Real>(rollingSize, 0));
+	}
+
+	Real& operator[](size_t index)
+	{
+		index &= indexMask;
+
+		if ((index >> chunkShift) >= chunks.size())
+		{
+			chunks.resize((index >> chunkShift) + 1, std::vector<Real>(chunkSize, 0));
+		}
+
+		return chunks[index >> chunkShift][index & (chunkSize - 1)];
+	}
+
+	Real operator[](size_t index) const
+	{
+		index &= indexMask;
+		return chunks[index >> chunkShift][index & (chunkSize - 1)];
+	}
+
+	//contiguous storage of one chunk, values [chunkIndex * chunkSize, (chunkIndex + 1) * chunkSize)
+	const Real* getChunk(size_t chunkIndex) const
+	{
+		return chunks[chunkIndex].data();
+	}
+
+	//number of values that fit into the allocated chunks
+	size_t capacity() const
+	{
+		return chunks.size() * chunkSize;
+	}
+
+private:
+	template <class Other>
+	friend class BasicTrajectoryField;
+
+	std::vector<std::vector<Real>> chunks;
+	size_t indexMask;
+};
+
+using TrajectoryField = BasicTrajectoryField<double>;
+
+#endif
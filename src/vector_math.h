@@ -0,0 +1,106 @@
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+//branch-free exp, log and pow for loops over arrays
+//written with plain arithmetic and bit casts only, so the compiler can vectorize loops calling them
+//accurate to a few ulp for arguments used in thermodynamic calculations (normal, positive log arguments)
+
+inline double vectorExp(double x)
+{
+	//reduction x = n * ln2 + r with |r| <= ln2 / 2, exp(r) from a degree 13 Taylor polynomial
+	const double log2e = 1.4426950408889634;
+	const double ln2Hi = 6.93147180369123816490e-01;
+	const double ln2Lo = 1.90821492927058770002e-10;
+	const double shifter = 6755399441055744.0; //1.5 * 2^52, adding it rounds to an integer
+	const uint64_t shifterBits = 0x4338000000000000ULL;
+
+	x = std::min(std::max(x, -708.0), 709.0);
+
+	double t = (x * log2e) + shifter;
+	double n = t - shifter;
+	double r = (x - (n * ln2Hi)) - (n * ln2Lo);
+
+	double p = 1.0 / 6227020800.0;
+	p = (p * r) + (1.0 / 479001600.0);
+	p = (p * r) + (1.0 / 39916800.0);
+	p = (p * r) + (1.0 / 3628800.0);
+	p = (p * r) + (1.0 / 362880.0);
+	p = (p * r) + (1.0 / 40320.0);
+	p = (p * r) + (1.0 / 5040.0);
+	p = (p * r) + (1.0 / 720.0);
+	p = (p * r) + (1.0 / 120.0);
+	p = (p * r) + (1.0 / 24.0);
+	p = (p * r) + (1.0 / 6.0);
+	p = (p * r) + 0.5;
+	p = (p * r) + 1.0;
+	p = (p * r) + 1.0;
+
+	//2^n built directly in the exponent bits, n is held in the low bits of t
+	uint64_t tBits;
+	std::memcpy(&tBits, &t, sizeof(double));
+	uint64_t scaleBits = ((tBits - shifterBits) + 1023) << 52;
+
+	double scale;
+	std::memcpy(&scale, &scaleBits, sizeof(double));
+
+	return p * scale;
+}
+
+inline double vectorLog(double x)
+{
+	//x = m * 2^e with m in [sqrt(2)/2, sqrt(2)), log(m) = 2 atanh(s) with s = (m - 1) / (m + 1)
+	const double ln2Hi = 6.93147180369123816490e-01;
+	const double ln2Lo = 1.90821492927058770002e-10;
+	const double sqrt2 = 1.4142135623730951;
+	const uint64_t mantissaMask = 0x000FFFFFFFFFFFFFULL;
+	const uint64_t oneBits = 0x3FF0000000000000ULL;
+	const uint64_t twoPow52Bits = 0x4330000000000000ULL;
+
+	uint64_t bits;
+	std::memcpy(&bits, &x, sizeof(double));
+
+	//biased exponent converted to double through the 2^52 trick
+	uint64_t exponentBits = twoPow52Bits | (bits >> 52);
+	double e;
+	std::memcpy(&e, &exponentBits, sizeof(double));
+	e -= 4503599627370496.0 + 1023.0;
+
+	uint64_t mantissaBits = (bits & mantissaMask) | oneBits;
+	double m;
+	std::memcpy(&m, &mantissaBits, sizeof(double));
+
+	bool isAboveSqrt2 = m > sqrt2;
+	m = isAboveSqrt2 ? m * 0.5 : m;
+	e = isAboveSqrt2 ? e + 1.0 : e;
+
+	double s = (m - 1.0) / (m + 1.0);
+	double s2 = s * s;
+
+	double p = 1.0 / 23.0;
+	p = (p * s2) + (1.0 / 21.0);
+	p = (p * s2) + (1.0 / 19.0);
+	p = (p * s2) + (1.0 / 17.0);
+	p = (p * s2) + (1.0 / 15.0);
+	p = (p * s2) + (1.0 / 13.0);
+	p = (p * s2) + (1.0 / 11.0);
+	p = (p * s2) + (1.0 / 9.0);
+	p = (p * s2) + (1.0 / 7.0);
+	p = (p * s2) + (1.0 / 5.0);
+	p = (p * s2) + (1.0 / 3.0);
+
+	double logMantissa = (2.0 * s) + (2.0 * s * s2 * p);
+
+	return (e * ln2Hi) + (logMantissa + (e * ln2Lo));
+}
+
+inline double vectorPow(double base, double exponent)
+{
+	//positive base only
+	return vectorExp(exponent * vectorLog(base));
+}
+
+#endif